@@ -0,0 +1,108 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ls2d.h"
+
+/**
+ * Microbenchmark comparing atomic (shared) and plain (thread-owned)
+ * reference counting under entity add/remove churn.
+ */
+
+#define BENCH_ENTITIES 10000
+#define BENCH_ROUNDS 100
+#define BENCH_REFS 8
+
+static Ls2DEntity *entities[BENCH_ENTITIES];
+
+static uint64_t bench_churn(bool shared)
+{
+        const uint64_t start = SDL_GetPerformanceCounter();
+
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+                /* Spawn, as a level load or spawner would */
+                for (int i = 0; i < BENCH_ENTITIES; i++) {
+                        Ls2DEntity *entity = ls2d_basic_entity_new("bench");
+                        Ls2DComponent *position = ls2d_position_component_new();
+
+                        ls2d_object_set_shared(entity, shared);
+                        ls2d_object_set_shared(position, shared);
+                        ls2d_entity_add_component(entity, position);
+                        ls2d_component_unref(position);
+                        entities[i] = entity;
+                }
+
+                /* Pass references around as scenes and containers do */
+                for (int i = 0; i < BENCH_ENTITIES; i++) {
+                        for (int r = 0; r < BENCH_REFS; r++) {
+                                ls2d_object_ref(entities[i]);
+                        }
+                        for (int r = 0; r < BENCH_REFS; r++) {
+                                ls2d_entity_unref(entities[i]);
+                        }
+                }
+
+                /* And remove them all again */
+                for (int i = 0; i < BENCH_ENTITIES; i++) {
+                        ls2d_entity_unref(entities[i]);
+                }
+        }
+
+        return ls2d_frame_info_counter_to_ns(SDL_GetPerformanceCounter() - start);
+}
+
+int main(__ls_unused__ int argc, __ls_unused__ char **argv)
+{
+        uint64_t atomic_ns, plain_ns;
+
+        /* Warm up the allocator so both runs start from the same state */
+        bench_churn(false);
+
+        atomic_ns = bench_churn(true);
+        plain_ns = bench_churn(false);
+
+        printf("%d rounds of %d entities\n", BENCH_ROUNDS, BENCH_ENTITIES);
+        printf("  atomic refcount: %.2f ms\n", (double)atomic_ns / (double)LS2D_NS_PER_MS);
+        printf("  plain refcount:  %.2f ms\n", (double)plain_ns / (double)LS2D_NS_PER_MS);
+        if (plain_ns > 0) {
+                printf("  speedup:         %.2fx\n", (double)atomic_ns / (double)plain_ns);
+        }
+
+        return EXIT_SUCCESS;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -33,7 +33,7 @@ struct Ls2DAnimation {
         LsArray *frames;
         uint16_t cur_frame;
         Ls2DTextureHandle handle;
-        uint32_t ticks;
+        uint64_t ticks; /**<Time spent on the current frame (ns) */
         bool looping;
         bool playing;
 };
@@ -43,7 +43,7 @@ struct Ls2DAnimation {
  * animation frames and retain a linear cache.
  */
 typedef struct Ls2DAnimationFrame {
-        uint32_t duration;
+        uint64_t duration; /**<Duration in ns */
         Ls2DTextureHandle handle;
 } Ls2DAnimationFrame;
 
@@ -104,7 +104,7 @@ bool ls2d_animation_add_frame(Ls2DAnimation *self, Ls2DTextureHandle handle, uin
                 return false;
         }
         frame->handle = handle;
-        frame->duration = duration;
+        frame->duration = duration * LS2D_NS_PER_MS;
 
         return true;
 }
@@ -112,6 +112,7 @@ bool ls2d_animation_add_frame(Ls2DAnimation *self, Ls2DTextureHandle handle, uin
 void ls2d_animation_update(Ls2DAnimation *self, Ls2DFrameInfo *frame)
 {
         Ls2DAnimationFrame *cur_frame = NULL;
+        LS2D_PROFILE_FUNC();
 
         if (ls_unlikely(!self)) {
                 return;
@@ -0,0 +1,165 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#include <SDL.h>
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ls2d.h"
+
+/**
+ * Usable bytes in each chunk we grab from the system. Anything larger is
+ * given a chunk to itself.
+ */
+#define LS2D_ARENA_CHUNK_SIZE (64 * 1024)
+
+/**
+ * Keep every allocation aligned for any object type
+ */
+#define LS2D_ARENA_ALIGN alignof(max_align_t)
+
+typedef struct Ls2DArenaChunk {
+        struct Ls2DArenaChunk *next;
+        size_t size; /**<Usable bytes in data */
+        size_t used;
+        alignas(LS2D_ARENA_ALIGN) unsigned char data[];
+} Ls2DArenaChunk;
+
+struct Ls2DArena {
+        Ls2DArenaChunk *chunks; /**<Most recent chunk first */
+        Ls2DArena *prev;        /**<Arena current before we were pushed */
+};
+
+static _Thread_local Ls2DArena *current_arena = NULL;
+
+Ls2DArena *ls2d_arena_new()
+{
+        return calloc(1, sizeof(struct Ls2DArena));
+}
+
+void ls2d_arena_free(Ls2DArena *self)
+{
+        Ls2DArenaChunk *chunk = NULL;
+
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        if (ls_unlikely(current_arena == self)) {
+                SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Freeing the current Ls2DArena");
+                current_arena = self->prev;
+        }
+
+        chunk = self->chunks;
+        while (chunk != NULL) {
+                Ls2DArenaChunk *next = chunk->next;
+                free(chunk);
+                chunk = next;
+        }
+        free(self);
+}
+
+static Ls2DArenaChunk *ls2d_arena_grow(Ls2DArena *self, size_t size)
+{
+        Ls2DArenaChunk *chunk = NULL;
+
+        if (size < LS2D_ARENA_CHUNK_SIZE) {
+                size = LS2D_ARENA_CHUNK_SIZE;
+        }
+        chunk = malloc(sizeof(struct Ls2DArenaChunk) + size);
+        if (ls_unlikely(!chunk)) {
+                return NULL;
+        }
+        chunk->size = size;
+        chunk->used = 0;
+        chunk->next = self->chunks;
+        self->chunks = chunk;
+        return chunk;
+}
+
+void *ls2d_arena_alloc(Ls2DArena *self, size_t size)
+{
+        Ls2DArenaChunk *chunk = NULL;
+        void *ret = NULL;
+
+        if (ls_unlikely(!self)) {
+                return NULL;
+        }
+
+        size = (size + LS2D_ARENA_ALIGN - 1) & ~(LS2D_ARENA_ALIGN - 1);
+        chunk = self->chunks;
+        if (!chunk || chunk->size - chunk->used < size) {
+                chunk = ls2d_arena_grow(self, size);
+                if (ls_unlikely(!chunk)) {
+                        return NULL;
+                }
+        }
+
+        ret = chunk->data + chunk->used;
+        chunk->used += size;
+        memset(ret, 0, size);
+        return ret;
+}
+
+void ls2d_arena_push(Ls2DArena *self)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        /* Each arena has one prev link, so it can only be on the stack once */
+        for (Ls2DArena *arena = current_arena; arena != NULL; arena = arena->prev) {
+                if (ls_unlikely(arena == self)) {
+                        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Ls2DArena is already pushed");
+                        return;
+                }
+        }
+        self->prev = current_arena;
+        current_arena = self;
+}
+
+void ls2d_arena_pop()
+{
+        if (ls_unlikely(!current_arena)) {
+                SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Unbalanced ls2d_arena_pop");
+                return;
+        }
+        current_arena = current_arena->prev;
+}
+
+Ls2DArena *ls2d_arena_get_current()
+{
+        return current_arena;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
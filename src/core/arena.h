@@ -0,0 +1,81 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include "ls2d.h"
+
+/**
+ * Bump allocator for objects which all die together. While an arena is
+ * pushed on a thread, ls2d_object_new on that thread allocates from it,
+ * and unreffing those objects still runs their destroy function but
+ * releases no memory. The memory is released in one go by ls2d_arena_free,
+ * so no object allocated from an arena may outlive it.
+ */
+
+/**
+ * Construct a new, empty Ls2DArena
+ */
+Ls2DArena *ls2d_arena_new(void);
+
+/**
+ * Release the arena and everything ever allocated from it
+ */
+void ls2d_arena_free(Ls2DArena *self);
+
+/**
+ * Allocate zeroed, suitably aligned memory from the arena
+ */
+void *ls2d_arena_alloc(Ls2DArena *self, size_t size);
+
+/**
+ * Make this the current arena for the calling thread. Pushes nest, and
+ * each must be matched with a call to ls2d_arena_pop. An arena that is
+ * already pushed can't be pushed again.
+ */
+void ls2d_arena_push(Ls2DArena *self);
+
+/**
+ * Restore the arena that was current before the last push
+ */
+void ls2d_arena_pop(void);
+
+/**
+ * Return the current arena for the calling thread, if any
+ */
+Ls2DArena *ls2d_arena_get_current(void);
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -178,6 +178,7 @@ bool ls2d_camera_get_world_bounds(Ls2DCamera *self, SDL_Rect *view)
                 return false;
         }
         *view = self->world_bounds;
+        return true;
 }
 
 /*
@@ -23,11 +23,66 @@
 
 #include "ls2d.h"
 
+/**
+ * Batch systems by component ID. Scenes collect the matching components
+ * when entities are added and hand them over in one call per frame.
+ */
+typedef struct Ls2DComponentSystem {
+        ls2d_component_system_func func;
+        uint32_t reads;
+        uint32_t writes;
+} Ls2DComponentSystem;
+
+static Ls2DComponentSystem component_systems[LS2D_COMP_ID_SLOTS] = {
+        [LS2D_COMP_ID_ANIMATION] = {
+                .func = ls2d_animation_component_update_all,
+                .writes = LS2D_COMP_MASK(LS2D_COMP_ID_ANIMATION),
+        },
+};
+
+static inline bool ls2d_component_id_valid(int component_id)
+{
+        return component_id >= 0 && component_id < LS2D_COMP_ID_SLOTS;
+}
+
+bool ls2d_component_register_system(int component_id, ls2d_component_system_func system,
+                                    uint32_t reads, uint32_t writes)
+{
+        if (ls_unlikely(!ls2d_component_id_valid(component_id))) {
+                return false;
+        }
+        component_systems[component_id] = (Ls2DComponentSystem){
+                .func = system,
+                .reads = reads,
+                .writes = writes,
+        };
+        return true;
+}
+
+ls2d_component_system_func ls2d_component_get_system(int component_id)
+{
+        if (ls_unlikely(!ls2d_component_id_valid(component_id))) {
+                return NULL;
+        }
+        return component_systems[component_id].func;
+}
+
+bool ls2d_component_get_system_access(int component_id, uint32_t *reads, uint32_t *writes)
+{
+        if (ls_unlikely(!ls2d_component_id_valid(component_id))) {
+                return false;
+        }
+        *reads = component_systems[component_id].reads;
+        *writes = component_systems[component_id].writes;
+        return true;
+}
+
 void ls2d_component_init(Ls2DComponent *self, Ls2DTextureCache *cache, Ls2DFrameInfo *frame)
 {
         if (ls_unlikely(!self) || ls_unlikely(!self->init)) {
                 return;
         }
+        LS2D_PROFILE_OBJECT(self);
         self->init(self, cache, frame);
 }
 
@@ -36,6 +91,7 @@ void ls2d_component_draw(Ls2DComponent *self, Ls2DTextureCache *cache, Ls2DFrame
         if (ls_unlikely(!self) || ls_unlikely(!self->draw)) {
                 return;
         }
+        LS2D_PROFILE_OBJECT(self);
         self->draw(self, cache, info);
 }
 
@@ -44,6 +100,7 @@ void ls2d_component_update(Ls2DComponent *self, Ls2DTextureCache *cache, Ls2DFra
         if (ls_unlikely(!self) || ls_unlikely(!self->update)) {
                 return;
         }
+        LS2D_PROFILE_OBJECT(self);
         self->update(self, cache, info);
 }
 
@@ -33,6 +33,7 @@ struct Ls2DComponent {
         Ls2DObject object;
         Ls2DEntity *parent_entity;
         int comp_id; /**<Public component ID */
+        bool batched; /**<Updated by the system for comp_id, not by update */
 
         /* Draw callback that all components should implemented */
         void (*draw)(struct Ls2DComponent *, Ls2DTextureCache *, Ls2DFrameInfo *);
@@ -44,6 +45,32 @@ struct Ls2DComponent {
         void (*init)(struct Ls2DComponent *, Ls2DTextureCache *, Ls2DFrameInfo *);
 };
 
+/**
+ * Batch update for every component of one type, called once per frame
+ * in place of each component's own update callback.
+ */
+typedef void (*ls2d_component_system_func)(Ls2DComponent **components, uint32_t n_components,
+                                           Ls2DTextureCache *cache, Ls2DFrameInfo *frame);
+
+/**
+ * Register the batch system for a component ID below LS2D_COMP_ID_SLOTS.
+ * This must happen before entities using the ID are added to a scene.
+ * reads and writes are the LS2D_COMP_MASK bits of component types the
+ * system touches, letting systems which don't conflict run concurrently.
+ */
+bool ls2d_component_register_system(int component_id, ls2d_component_system_func system,
+                                    uint32_t reads, uint32_t writes);
+
+/**
+ * Retrieve the declared access of a component ID's batch system
+ */
+bool ls2d_component_get_system_access(int component_id, uint32_t *reads, uint32_t *writes);
+
+/**
+ * Return the batch system for a component ID, if any
+ */
+ls2d_component_system_func ls2d_component_get_system(int component_id);
+
 void ls2d_component_init(Ls2DComponent *self, Ls2DTextureCache *, Ls2DFrameInfo *frame);
 
 /**
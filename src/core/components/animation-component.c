@@ -137,6 +137,18 @@ static void ls2d_animation_component_update(Ls2DComponent *component,
         ls2d_animation_update(self->cur_anim, frame);
 }
 
+void ls2d_animation_component_update_all(Ls2DComponent **components, uint32_t n_components,
+                                          __ls_unused__ Ls2DTextureCache *cache,
+                                          Ls2DFrameInfo *frame)
+{
+        for (uint32_t i = 0; i < n_components; i++) {
+                Ls2DAnimationComponent *self = (Ls2DAnimationComponent *)components[i];
+                if (ls_likely(self->cur_anim != NULL)) {
+                        ls2d_animation_update(self->cur_anim, frame);
+                }
+        }
+}
+
 Ls2DTextureHandle ls2d_animation_component_get_texture(Ls2DAnimationComponent *self)
 {
         if (ls_unlikely(!self)) {
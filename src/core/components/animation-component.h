@@ -58,6 +58,12 @@ bool ls2d_animation_component_set_animation(Ls2DAnimationComponent *self, const
  */
 Ls2DTextureHandle ls2d_animation_component_get_texture(Ls2DAnimationComponent *self);
 
+/**
+ * Batch system stepping the current animation of each component
+ */
+void ls2d_animation_component_update_all(Ls2DComponent **components, uint32_t n_components,
+                                          Ls2DTextureCache *cache, Ls2DFrameInfo *frame);
+
 DEF_AUTOFREE(Ls2DAnimationComponent, ls2d_animation_component_unref)
 
 /*
@@ -62,12 +62,25 @@ Ls2DPositionComponent *ls2d_position_component_unref(Ls2DPositionComponent *self
         return ls2d_object_unref(self);
 }
 
+/**
+ * Let the scene know our entity needs re-sorting and re-indexing
+ */
+static void ls2d_position_component_moved(Ls2DPositionComponent *self)
+{
+        Ls2DEntity *entity = self->parent.parent_entity;
+
+        if (entity != NULL && entity->scene != NULL) {
+                ls2d_scene_entity_moved(entity->scene, entity->handle);
+        }
+}
+
 void ls2d_position_component_set_xy(Ls2DPositionComponent *self, SDL_Point pos)
 {
         if (ls_unlikely(!self)) {
                 return;
         }
         self->pos = pos;
+        ls2d_position_component_moved(self);
 }
 
 void ls2d_position_component_set_z(Ls2DPositionComponent *self, int z)
@@ -76,6 +89,7 @@ void ls2d_position_component_set_z(Ls2DPositionComponent *self, int z)
                 return;
         }
         self->pos_z = z;
+        ls2d_position_component_moved(self);
 }
 
 bool ls2d_position_component_get_z(Ls2DPositionComponent *self, int *z)
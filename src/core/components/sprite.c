@@ -36,6 +36,7 @@ struct Ls2DSpriteComponent {
         Ls2DTextureHandle handle;
         SDL_RendererFlip flip;
         double rotation;
+        SDL_Color color;
 };
 
 static void ls2d_sprite_component_draw(Ls2DComponent *self, Ls2DTextureCache *cache,
@@ -59,6 +60,7 @@ static void ls2d_sprite_component_init(Ls2DSpriteComponent *self)
 {
         self->flip = SDL_FLIP_NONE;
         self->rotation = 0.0;
+        self->color = (SDL_Color){ 255, 255, 255, 255 };
         self->parent.draw = ls2d_sprite_component_draw;
         self->parent.comp_id = LS2D_COMP_ID_SPRITE;
 }
@@ -73,6 +75,21 @@ void ls2d_sprite_component_set_texture(Ls2DSpriteComponent *self, Ls2DTextureHan
         self->handle = handle;
 }
 
+/**
+ * The texture to draw, following any animation on the entity
+ */
+static Ls2DTextureHandle ls2d_sprite_component_get_handle(Ls2DSpriteComponent *self)
+{
+        Ls2DAnimationComponent *anim = NULL;
+
+        anim = (Ls2DAnimationComponent *)ls2d_entity_get_component(self->parent.parent_entity,
+                                                                   LS2D_COMP_ID_ANIMATION);
+        if (anim) {
+                return ls2d_animation_component_get_texture(anim);
+        }
+        return self->handle;
+}
+
 /**
  * Perform the actual sprite drawing. Long story short, we need to
  * draw to our X, Y coordinates if within clip using our set
@@ -82,19 +99,12 @@ void ls2d_sprite_component_draw(Ls2DComponent *component, Ls2DTextureCache *cach
                                 Ls2DFrameInfo *frame)
 {
         Ls2DSpriteComponent *self = (Ls2DSpriteComponent *)component;
-        Ls2DAnimationComponent *anim = NULL;
         SDL_Rect area = { 0, 0, 0, 0 };
         SDL_Point xy = { 0, 0 };
-        Ls2DTextureHandle handle = self->handle;
-
-        anim = (Ls2DAnimationComponent *)ls2d_entity_get_component(component->parent_entity,
-                                                                   LS2D_COMP_ID_ANIMATION);
-        if (anim) {
-                handle = ls2d_animation_component_get_texture(anim);
-        }
 
         /* Grab a texture */
-        const Ls2DTextureNode *node = ls2d_texture_cache_lookup(cache, frame, handle);
+        const Ls2DTextureNode *node =
+            ls2d_texture_cache_lookup(cache, frame, ls2d_sprite_component_get_handle(self));
         if (!node) {
                 return;
         }
@@ -114,13 +124,7 @@ void ls2d_sprite_component_draw(Ls2DComponent *component, Ls2DTextureCache *cach
         dst.h /= 3;
 
         /* TODO: Add anchor support. */
-        SDL_RenderCopyEx(frame->renderer,
-                         node->texture,
-                         node->subregion ? &node->area : NULL,
-                         &dst,
-                         self->rotation,
-                         NULL,
-                         self->flip);
+        ls2d_render_copy_color(frame, node, NULL, &dst, self->rotation, self->flip, self->color);
 }
 
 void ls2d_sprite_component_set_flip(Ls2DSpriteComponent *self, SDL_RendererFlip flip)
@@ -139,6 +143,39 @@ void ls2d_sprite_component_set_rotation(Ls2DSpriteComponent *self, double rotati
         self->rotation = rotation;
 }
 
+void ls2d_sprite_component_set_color(Ls2DSpriteComponent *self, SDL_Color color)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        self->color = color;
+}
+
+bool ls2d_sprite_component_get_size(Ls2DSpriteComponent *self, Ls2DTextureCache *cache,
+                                    SDL_Point *size)
+{
+        const Ls2DTextureNode *node = NULL;
+
+        if (ls_unlikely(!self) || ls_unlikely(!size)) {
+                return false;
+        }
+        /* Peek, as decoding here would happen on the simulation thread */
+        node = ls2d_texture_cache_peek(cache, ls2d_sprite_component_get_handle(self));
+        if (!node) {
+                /* Never drawn, so takes no room */
+                size->x = 0;
+                size->y = 0;
+                return true;
+        }
+        if (!node->subregion && !node->loaded) {
+                return false;
+        }
+        /* Must match the scaling in ls2d_sprite_component_draw */
+        size->x = node->area.w / 3;
+        size->y = node->area.h / 3;
+        return true;
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
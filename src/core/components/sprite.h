@@ -47,6 +47,19 @@ void ls2d_sprite_component_set_flip(Ls2DSpriteComponent *self, SDL_RendererFlip
 
 void ls2d_sprite_component_set_rotation(Ls2DSpriteComponent *self, double rotation);
 
+/**
+ * Modulate the sprite by color, white being untinted
+ */
+void ls2d_sprite_component_set_color(Ls2DSpriteComponent *self, SDL_Color color);
+
+/**
+ * Store the on-screen width and height of the sprite's current texture
+ * in size. This never decodes the texture, so returns false if its size
+ * isn't known until it has been loaded.
+ */
+bool ls2d_sprite_component_get_size(Ls2DSpriteComponent *self, Ls2DTextureCache *cache,
+                                    SDL_Point *size);
+
 DEF_AUTOFREE(Ls2DSpriteComponent, ls2d_sprite_component_unref)
 
 /*
@@ -0,0 +1,313 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ls2d.h"
+
+static void ls2d_transform_component_init(Ls2DTransformComponent *self);
+static void ls2d_transform_component_destroy(Ls2DTransformComponent *self);
+
+/**
+ * Opaque Ls2DTransformComponent implementation
+ */
+struct Ls2DTransformComponent {
+        Ls2DComponent parent; /*< Parent */
+        Ls2DTransformComponent *parent_transform;
+
+        SDL_Point local;
+        int local_z;
+        SDL_Point world;
+        int world_z;
+
+        bool dirty;              /**<Local transform or parent changed */
+        uint32_t version;        /**<Bumped whenever world changes */
+        uint32_t parent_version; /**<Parent's version when world was computed */
+        uint32_t order;          /**<Index in the last array we propagated */
+        uint32_t depth;
+};
+
+/**
+ * We don't yet do anything fancy.
+ */
+Ls2DObjectTable transform_component_vtable = {
+        .obj_name = "Ls2DTransformComponent",
+        .init = (ls2d_object_vfunc_init)ls2d_transform_component_init,
+        .destroy = (ls2d_object_vfunc_destroy)ls2d_transform_component_destroy,
+};
+
+Ls2DComponent *ls2d_transform_component_new()
+{
+        return (Ls2DComponent *)LS2D_NEW(Ls2DTransformComponent, transform_component_vtable);
+}
+
+static void ls2d_transform_component_init(Ls2DTransformComponent *self)
+{
+        self->parent.comp_id = LS2D_COMP_ID_TRANSFORM;
+        self->dirty = true;
+        self->order = UINT32_MAX;
+}
+
+static void ls2d_transform_component_destroy(Ls2DTransformComponent *self)
+{
+        if (self->parent_transform != NULL) {
+                ls2d_transform_component_unref(self->parent_transform);
+        }
+}
+
+Ls2DTransformComponent *ls2d_transform_component_unref(Ls2DTransformComponent *self)
+{
+        return ls2d_object_unref(self);
+}
+
+bool ls2d_transform_component_set_parent(Ls2DTransformComponent *self,
+                                         Ls2DTransformComponent *parent)
+{
+        if (ls_unlikely(!self)) {
+                return false;
+        }
+        for (Ls2DTransformComponent *node = parent; node != NULL; node = node->parent_transform) {
+                if (ls_unlikely(node == self)) {
+                        SDL_LogError(SDL_LOG_CATEGORY_ERROR,
+                                     "Ls2DTransformComponent can't be its own ancestor");
+                        return false;
+                }
+        }
+
+        if (parent != NULL) {
+                ls2d_object_ref(parent);
+        }
+        if (self->parent_transform != NULL) {
+                ls2d_transform_component_unref(self->parent_transform);
+        }
+        self->parent_transform = parent;
+        self->dirty = true;
+        return true;
+}
+
+Ls2DTransformComponent *ls2d_transform_component_get_parent(Ls2DTransformComponent *self)
+{
+        if (ls_unlikely(!self)) {
+                return NULL;
+        }
+        return self->parent_transform;
+}
+
+void ls2d_transform_component_set_local(Ls2DTransformComponent *self, SDL_Point pos)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        self->local = pos;
+        self->dirty = true;
+}
+
+void ls2d_transform_component_set_local_z(Ls2DTransformComponent *self, int z)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        self->local_z = z;
+        self->dirty = true;
+}
+
+bool ls2d_transform_component_get_local(Ls2DTransformComponent *self, SDL_Point *pos)
+{
+        if (ls_unlikely(!self) || ls_unlikely(!pos)) {
+                return false;
+        }
+        *pos = self->local;
+        return true;
+}
+
+bool ls2d_transform_component_get_world(Ls2DTransformComponent *self, SDL_Point *pos)
+{
+        if (ls_unlikely(!self) || ls_unlikely(!pos)) {
+                return false;
+        }
+        *pos = self->world;
+        return true;
+}
+
+bool ls2d_transform_component_get_world_z(Ls2DTransformComponent *self, int *z)
+{
+        if (ls_unlikely(!self) || ls_unlikely(!z)) {
+                return false;
+        }
+        *z = self->world_z;
+        return true;
+}
+
+/**
+ * Is the parent in the array ahead of us, where propagation reaches it first?
+ */
+static inline bool ls2d_transform_parent_is_ahead(Ls2DTransformComponent **transforms,
+                                                  uint32_t index)
+{
+        Ls2DTransformComponent *parent = transforms[index]->parent_transform;
+
+        return parent->order < index && transforms[parent->order] == parent;
+}
+
+/**
+ * Breadth-first means every parent in the array comes before its children,
+ * and nothing has been added, removed or moved since we numbered them.
+ */
+static bool ls2d_transform_is_ordered(Ls2DTransformComponent **transforms, uint32_t n)
+{
+        for (uint32_t i = 0; i < n; i++) {
+                Ls2DTransformComponent *self = transforms[i];
+                Ls2DTransformComponent *parent = self->parent_transform;
+
+                if (self->order != i) {
+                        return false;
+                }
+                if (parent == NULL || ls2d_transform_parent_is_ahead(transforms, i)) {
+                        continue;
+                }
+                /* Parent lives elsewhere, unless it's further along in here */
+                if (parent->order < n && transforms[parent->order] == parent) {
+                        return false;
+                }
+        }
+        return true;
+}
+
+/**
+ * Stable counting sort by depth. Parents outside the array still count
+ * towards depth, which only ever moves their children later.
+ */
+static bool ls2d_transform_sort(Ls2DTransformComponent **transforms, uint32_t n)
+{
+        Ls2DTransformComponent **sorted = NULL;
+        uint32_t *offsets = NULL;
+        uint32_t max_depth = 0;
+
+        for (uint32_t i = 0; i < n; i++) {
+                uint32_t depth = 0;
+                for (Ls2DTransformComponent *node = transforms[i]->parent_transform; node != NULL;
+                     node = node->parent_transform) {
+                        depth++;
+                }
+                transforms[i]->depth = depth;
+                if (depth > max_depth) {
+                        max_depth = depth;
+                }
+        }
+
+        sorted = malloc(n * sizeof(Ls2DTransformComponent *));
+        offsets = calloc(max_depth + 1, sizeof(uint32_t));
+        if (ls_unlikely(!sorted) || ls_unlikely(!offsets)) {
+                free(sorted);
+                free(offsets);
+                return false;
+        }
+
+        for (uint32_t i = 0; i < n; i++) {
+                offsets[transforms[i]->depth]++;
+        }
+        for (uint32_t depth = 0, total = 0; depth <= max_depth; depth++) {
+                uint32_t count = offsets[depth];
+                offsets[depth] = total;
+                total += count;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+                sorted[offsets[transforms[i]->depth]++] = transforms[i];
+        }
+        for (uint32_t i = 0; i < n; i++) {
+                transforms[i] = sorted[i];
+                transforms[i]->order = i;
+        }
+
+        free(sorted);
+        free(offsets);
+        return true;
+}
+
+/**
+ * Write the world transform through to the entity's position component
+ */
+static void ls2d_transform_apply(Ls2DTransformComponent *self)
+{
+        Ls2DComponent *position = NULL;
+
+        if (!self->parent.parent_entity) {
+                return;
+        }
+        position = ls2d_entity_get_component(self->parent.parent_entity, LS2D_COMP_ID_POSITION);
+        if (!position) {
+                return;
+        }
+        ls2d_position_component_set_xy((Ls2DPositionComponent *)position, self->world);
+        ls2d_position_component_set_z((Ls2DPositionComponent *)position, self->world_z);
+}
+
+void ls2d_transform_component_propagate(Ls2DComponent **components, uint32_t n_components)
+{
+        Ls2DTransformComponent **transforms = (Ls2DTransformComponent **)components;
+
+        LS2D_PROFILE_FUNC();
+
+        if (!ls2d_transform_is_ordered(transforms, n_components) &&
+            ls_unlikely(!ls2d_transform_sort(transforms, n_components))) {
+                return;
+        }
+
+        /* Parents come first, so their world is final by the time we need it */
+        for (uint32_t i = 0; i < n_components; i++) {
+                Ls2DTransformComponent *self = transforms[i];
+                Ls2DTransformComponent *parent = self->parent_transform;
+
+                if (!self->dirty && (!parent || parent->version == self->parent_version)) {
+                        continue;
+                }
+
+                self->world = self->local;
+                self->world_z = self->local_z;
+                if (parent != NULL) {
+                        self->world.x += parent->world.x;
+                        self->world.y += parent->world.y;
+                        self->world_z += parent->world_z;
+                        self->parent_version = parent->version;
+                }
+                self->dirty = false;
+                self->version++;
+                ls2d_transform_apply(self);
+        }
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,103 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#pragma once
+
+#include "ls2d.h"
+
+/**
+ * Ls2DTransformComponent places an Ls2DEntity relative to a parent
+ * transform, so composite objects move as one. The world position is
+ * written through to the entity's position component.
+ */
+typedef struct Ls2DTransformComponent Ls2DTransformComponent;
+
+/**
+ * Construct a new transform with no parent, at the origin.
+ */
+Ls2DComponent *ls2d_transform_component_new(void);
+
+/**
+ * Unref an allocated transform, and its reference on the parent.
+ */
+Ls2DTransformComponent *ls2d_transform_component_unref(Ls2DTransformComponent *self);
+
+/**
+ * Attach to a parent transform, or detach with NULL. Fails if this would
+ * make a transform its own ancestor.
+ */
+bool ls2d_transform_component_set_parent(Ls2DTransformComponent *self,
+                                         Ls2DTransformComponent *parent);
+
+/**
+ * Get the parent transform, if any
+ */
+Ls2DTransformComponent *ls2d_transform_component_get_parent(Ls2DTransformComponent *self);
+
+/**
+ * Set the X and Y offset from the parent, or the world position for roots
+ */
+void ls2d_transform_component_set_local(Ls2DTransformComponent *self, SDL_Point pos);
+
+/**
+ * Set the Z offset from the parent
+ */
+void ls2d_transform_component_set_local_z(Ls2DTransformComponent *self, int z);
+
+/**
+ * Get the X and Y offset from the parent into pos
+ */
+bool ls2d_transform_component_get_local(Ls2DTransformComponent *self, SDL_Point *pos);
+
+/**
+ * Get the world X and Y into pos, as of the last propagation
+ */
+bool ls2d_transform_component_get_world(Ls2DTransformComponent *self, SDL_Point *pos);
+
+/**
+ * Get the world Z, as of the last propagation
+ */
+bool ls2d_transform_component_get_world_z(Ls2DTransformComponent *self, int *z);
+
+/**
+ * Recompute world transforms for every transform whose local transform
+ * or parent changed, in one pass. Scenes do this for their own entities
+ * after each update. The array is reordered in place, breadth-first, when
+ * the hierarchy has changed since the last call.
+ */
+void ls2d_transform_component_propagate(Ls2DComponent **transforms, uint32_t n_transforms);
+
+DEF_AUTOFREE(Ls2DTransformComponent, ls2d_transform_component_unref)
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -25,27 +25,114 @@
 
 #include "engine-private.h"
 #include "libls.h"
+#include "render-private.h"
 
-void ls2d_engine_draw(Ls2DEngine *self, Ls2DFrameInfo *frame)
+/**
+ * Lazily create the offscreen buffer at the logical size
+ */
+static bool ls2d_engine_ensure_buffer(Ls2DEngine *self)
+{
+        if (ls_likely(self->buffer != NULL)) {
+                return true;
+        }
+
+        self->buffer = SDL_CreateTexture(self->render,
+                                         SDL_PIXELFORMAT_RGBA8888,
+                                         SDL_TEXTUREACCESS_TARGET,
+                                         self->width,
+                                         self->height);
+        if (ls_unlikely(!self->buffer)) {
+                SDL_LogError(SDL_LOG_CATEGORY_VIDEO,
+                             "Couldn't create offscreen buffer, rendering directly: %s",
+                             SDL_GetError());
+                self->direct_render = true;
+                self->frame_budget = 0;
+                return false;
+        }
+        return true;
+}
+
+/**
+ * The region of the buffer in use at the current render scale
+ */
+static inline SDL_Rect ls2d_engine_buffer_area(Ls2DEngine *self)
 {
+        return (SDL_Rect){
+                .x = 0,
+                .y = 0,
+                .w = (int)((double)self->width * self->render_scale + 0.5),
+                .h = (int)((double)self->height * self->render_scale + 0.5),
+        };
+}
+
+static void ls2d_engine_draw_begin(Ls2DEngine *self)
+{
+        const SDL_Rect logical = { 0, 0, self->width, self->height };
+
         /* Clear the background */
         SDL_SetRenderDrawColor(self->render, 52, 39, 89, 255);
         SDL_RenderClear(self->render);
 
-        /* Clear old bfufer */
+        if (!ls2d_engine_needs_buffer(self) || !ls2d_engine_ensure_buffer(self)) {
+                return;
+        }
+
+        /* Scaling only lasts while the buffer is the target */
         SDL_SetRenderTarget(self->render, self->buffer);
-        SDL_RenderClear(self->render);
+        if (self->render_scale < 1.0) {
+                SDL_RenderSetScale(self->render,
+                                   (float)self->render_scale,
+                                   (float)self->render_scale);
+        }
+
+        /* Clear only the part of the old buffer we'll use */
+        SDL_RenderFillRect(self->render, &logical);
+}
+
+static void ls2d_engine_draw_end(Ls2DEngine *self)
+{
+        SDL_Rect area = { 0 };
+
+        /* Copy the buffer in, upscaling if needed */
+        if (ls2d_engine_needs_buffer(self) && ls_likely(self->buffer != NULL)) {
+                area = ls2d_engine_buffer_area(self);
+                SDL_SetRenderTarget(self->render, NULL);
+                SDL_RenderCopy(self->render, self->buffer, &area, NULL);
+        }
+
+        SDL_RenderPresent(self->render);
+}
+
+void ls2d_engine_draw(Ls2DEngine *self, Ls2DFrameInfo *frame)
+{
+        LS2D_PROFILE_FUNC();
+
+        ls2d_engine_draw_begin(self);
 
-        /* Draw the active scene */
+        /* Record the scene so its draws can be batched, or draw directly if we can't */
+        if (ls_unlikely(!self->queue)) {
+                self->queue = ls2d_render_queue_new();
+        }
         if (ls_likely(self->active_scene != NULL)) {
+                frame->queue = self->queue;
                 ls2d_scene_draw(self->active_scene, frame);
+                frame->queue = NULL;
+        }
+        if (ls_likely(self->queue != NULL)) {
+                ls2d_render_queue_execute(self->queue, self->render);
+                ls2d_render_queue_reset(self->queue);
         }
 
-        /* Copy the buffer in */
-        SDL_SetRenderTarget(self->render, NULL);
-        SDL_RenderCopy(self->render, self->buffer, NULL, NULL);
+        ls2d_engine_draw_end(self);
+}
 
-        SDL_RenderPresent(self->render);
+void ls2d_engine_present_queue(Ls2DEngine *self, Ls2DRenderQueue *queue)
+{
+        LS2D_PROFILE_FUNC();
+
+        ls2d_engine_draw_begin(self);
+        ls2d_render_queue_execute(queue, self->render);
+        ls2d_engine_draw_end(self);
 }
 
 /*
@@ -0,0 +1,183 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#include <SDL.h>
+
+#include "engine-private.h"
+
+static int ls2d_engine_preload_worker(void *data)
+{
+        Ls2DPreload *preload = data;
+        Ls2DTextureCache *cache = ls2d_scene_get_texture_cache(preload->scene);
+
+        if (preload->loader && !preload->loader(preload->scene, preload->userdata)) {
+                atomic_store(&preload->state, LS2D_PRELOAD_FAILED);
+                return 1;
+        }
+
+        atomic_store(&preload->total, ls2d_texture_cache_count_images(cache));
+        atomic_store(&preload->state, LS2D_PRELOAD_DECODING);
+        ls2d_texture_cache_decode_all(cache, &preload->decoded);
+
+        /* Hand the scene over to the render thread */
+        atomic_store(&preload->state, LS2D_PRELOAD_UPLOADING);
+        return 0;
+}
+
+void ls2d_engine_preload_clear(Ls2DEngine *self)
+{
+        Ls2DPreload *preload = &self->preload;
+
+        if (preload->thread != NULL) {
+                SDL_WaitThread(preload->thread, NULL);
+                preload->thread = NULL;
+        }
+        if (preload->scene != NULL) {
+                ls2d_scene_unref(preload->scene);
+                preload->scene = NULL;
+        }
+}
+
+bool ls2d_engine_preload_scene(Ls2DEngine *self, Ls2DScene *scene,
+                               ls2d_engine_preload_func loader, void *userdata)
+{
+        Ls2DPreload *preload = NULL;
+        Ls2DPreloadState state;
+
+        if (ls_unlikely(!self) || ls_unlikely(!scene)) {
+                return false;
+        }
+
+        preload = &self->preload;
+        state = atomic_load(&preload->state);
+        if (state != LS2D_PRELOAD_IDLE && state != LS2D_PRELOAD_READY &&
+            state != LS2D_PRELOAD_FAILED) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "A scene is already being preloaded");
+                return false;
+        }
+        ls2d_engine_preload_clear(self);
+
+        /* Referenced from here and from the worker thread from now on */
+        ls2d_object_set_shared(scene, true);
+        preload->scene = ls2d_object_ref(scene);
+        preload->loader = loader;
+        preload->userdata = userdata;
+        atomic_store(&preload->total, 0);
+        atomic_store(&preload->decoded, 0);
+        atomic_store(&preload->uploaded, 0);
+        atomic_store(&preload->state, LS2D_PRELOAD_LOADING);
+
+        preload->thread = SDL_CreateThread(ls2d_engine_preload_worker, "ls2d-preload", preload);
+        if (!preload->thread) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+                             "Couldn't create preload thread: %s",
+                             SDL_GetError());
+                atomic_store(&preload->state, LS2D_PRELOAD_FAILED);
+                return false;
+        }
+
+        return true;
+}
+
+void ls2d_engine_process_preload(Ls2DEngine *self)
+{
+        Ls2DPreload *preload = &self->preload;
+        Ls2DTextureCache *cache = NULL;
+        uint64_t start;
+
+        switch (atomic_load(&preload->state)) {
+        case LS2D_PRELOAD_FAILED:
+                ls2d_engine_preload_clear(self);
+                return;
+        case LS2D_PRELOAD_UPLOADING:
+                break;
+        default:
+                return;
+        }
+
+        /* Worker has finished with the scene by now */
+        if (preload->thread != NULL) {
+                SDL_WaitThread(preload->thread, NULL);
+                preload->thread = NULL;
+        }
+
+        cache = ls2d_scene_get_texture_cache(preload->scene);
+        start = SDL_GetPerformanceCounter();
+        while (ls2d_frame_info_counter_to_ns(SDL_GetPerformanceCounter() - start) <
+               LS2D_PRELOAD_UPLOAD_NS) {
+                if (ls2d_texture_cache_upload(cache, self->render, 1) == 0) {
+                        atomic_store(&preload->state, LS2D_PRELOAD_READY);
+                        break;
+                }
+                atomic_fetch_add(&preload->uploaded, 1);
+        }
+}
+
+Ls2DPreloadState ls2d_engine_get_preload_state(Ls2DEngine *self, double *progress)
+{
+        Ls2DPreload *preload = NULL;
+        Ls2DPreloadState state;
+        unsigned int total;
+        unsigned int done;
+
+        if (ls_unlikely(!self)) {
+                return LS2D_PRELOAD_IDLE;
+        }
+
+        preload = &self->preload;
+        state = atomic_load(&preload->state);
+        if (!progress) {
+                return state;
+        }
+
+        /* Decoding and uploading each account for half of the work */
+        total = atomic_load(&preload->total);
+        switch (state) {
+        case LS2D_PRELOAD_DECODING:
+        case LS2D_PRELOAD_UPLOADING:
+                done = atomic_load(&preload->decoded) + atomic_load(&preload->uploaded);
+                *progress = total > 0 ? (double)done / (2.0 * total) : 0.0;
+                break;
+        case LS2D_PRELOAD_READY:
+                *progress = 1.0;
+                break;
+        default:
+                *progress = 0.0;
+                break;
+        }
+
+        return state;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <SDL.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdlib.h>
 
@@ -31,6 +32,58 @@
 
 /** Private API headers for the engine implementation */
 
+/**
+ * Upper bound on simulation ticks per frame in fixed-step mode, so that
+ * a long stall doesn't spiral into ever-longer catch-up frames.
+ */
+#define LS2D_MAX_TICKS_PER_FRAME 5
+
+/**
+ * Synthetic frame step used for replays when no tick rate is set
+ */
+#define LS2D_REPLAY_STEP_NS (LS2D_NS_PER_SEC / 60)
+
+/**
+ * Number of frames retained for Ls2DEngineStats
+ */
+#define LS2D_STATS_SAMPLES 1024
+
+/**
+ * How often the window title may be refreshed with the framerate
+ */
+#define LS2D_TITLE_INTERVAL_NS (LS2D_NS_PER_SEC / 2)
+
+/**
+ * Fixed-size ring of frame timings (ns), so that recording a frame never
+ * needs to allocate.
+ */
+typedef struct Ls2DStatsRing {
+        uint64_t frame[LS2D_STATS_SAMPLES];
+        uint64_t update[LS2D_STATS_SAMPLES];
+        uint64_t draw[LS2D_STATS_SAMPLES];
+        uint64_t count; /**<Total samples pushed */
+} Ls2DStatsRing;
+
+/**
+ * Budget for texture uploads from a preload, per frame
+ */
+#define LS2D_PRELOAD_UPLOAD_NS (2 * LS2D_NS_PER_MS)
+
+/**
+ * Background scene load. The worker thread owns the scene until it moves
+ * the state on to uploading, after which only the render thread touches it.
+ */
+typedef struct Ls2DPreload {
+        SDL_Thread *thread;
+        Ls2DScene *scene;
+        ls2d_engine_preload_func loader;
+        void *userdata;
+        atomic_int state;      /**<Ls2DPreloadState */
+        atomic_uint total;     /**<Images in the scene once loaded */
+        atomic_uint decoded;   /**<Images decoded so far */
+        atomic_uint uploaded;  /**<Textures uploaded so far */
+} Ls2DPreload;
+
 /**
  * Ls2DEngine is responsible for managing the primary output, setting up
  * the event dispatch system, etc.
@@ -39,30 +92,119 @@ struct Ls2DEngine {
         Ls2DObject object; /*< Parent */
         int width;
         int height;
-        uint32_t fps_delay;
+        uint64_t frame_time;       /**<Minimum frame time (ns) when capped */
+        Ls2DFrameMode frame_mode;  /**<How we pace presentation */
+        uint64_t tick_step;        /**<Fixed simulation step (ns), or 0 for variable */
+        uint64_t tick_accumulator; /**<Unsimulated time carried to the next frame */
         SDL_Window *window;
+        SDL_Surface *surface; /**<Offscreen target when headless */
         SDL_Renderer *render;
-        bool running;
+        atomic_bool running; /**<Shared with the simulation thread */
         bool fullscreen;
+        bool headless;
+        bool threaded;      /**<Simulate on a worker thread, render on this one */
+        bool direct_render; /**<Skip the offscreen buffer where possible */
+        uint64_t frame_budget; /**<Dynamic resolution budget (ns), 0 when disabled */
+        double render_scale;   /**<Fraction of the logical size we render at */
+        int scale_step;        /**<Whole steps render_scale is below 1.0 */
+        int scale_votes;       /**<Consecutive windows with headroom to step up */
+        uint64_t scale_frame;  /**<Stats sample at which render_scale last changed */
+        uint64_t scale_sample; /**<Stats sample at which timings were last judged */
+        uint64_t frame_limit; /**<Stop after this many frames, 0 for no limit */
+        bool show_fps;
+        uint64_t title_ticks; /**<When we last set the window title */
+        Ls2DStatsRing stats;
 
         /* List of scenes. */
         LsList *scenes;
         Ls2DScene *active_scene;
+        Ls2DPreload preload;
         Ls2DInputManager *input_manager;
-        SDL_Texture *buffer;
+        Ls2DReplay *recorder; /**<Live events are appended here if set */
+        Ls2DJobPool *jobs;    /**<Workers for scene updates, if enabled */
+        SDL_Texture *buffer; /**<Offscreen target, created on demand */
+        Ls2DRenderQueue *queue; /**<Draws recorded for batching when not threaded */
         Ls2DGame *game;
 };
 
 /**
- * Process all incoming events to the engine (input/updates)
+ * Whether the scene must be rendered offscreen before presenting
+ */
+static inline bool ls2d_engine_needs_buffer(Ls2DEngine *self)
+{
+        return !self->direct_render || self->frame_budget > 0;
+}
+
+/**
+ * Process all incoming events to the engine (input)
  */
 void ls2d_engine_process_events(Ls2DEngine *self, Ls2DFrameInfo *frame);
 
+/**
+ * Dispatch a single event through the input manager and engine handlers
+ */
+void ls2d_engine_dispatch_event(Ls2DEngine *self, SDL_Event *event, Ls2DFrameInfo *frame);
+
+/**
+ * Handle engine-level events (quit, fullscreen toggle), skipping the
+ * input manager entirely.
+ */
+void ls2d_engine_handle_event(Ls2DEngine *self, SDL_Event *event);
+
+/**
+ * Dispatch any replay events now due in place of live input
+ */
+void ls2d_engine_process_replay(Ls2DEngine *self, Ls2DReplay *replay, Ls2DFrameInfo *frame);
+
+/**
+ * Advance the simulation of the active scene. In fixed-step mode this
+ * may run zero or more scene updates and will set the frame alpha.
+ */
+void ls2d_engine_update(Ls2DEngine *self, Ls2DFrameInfo *frame);
+
+/**
+ * Record the timings (ns) for a completed frame
+ */
+void ls2d_engine_stats_push(Ls2DEngine *self, uint64_t frame, uint64_t update, uint64_t draw);
+
+/**
+ * Upload textures for a preloaded scene, within the per-frame budget.
+ * Must be called from the thread owning the renderer.
+ */
+void ls2d_engine_process_preload(Ls2DEngine *self);
+
+/**
+ * Wait for any preload thread to finish and release its scene
+ */
+void ls2d_engine_preload_clear(Ls2DEngine *self);
+
+/**
+ * Adjust render_scale from the recent frame timings when dynamic
+ * resolution is enabled.
+ */
+void ls2d_engine_update_resolution(Ls2DEngine *self);
+
+/**
+ * Refresh the window title with the current framerate, if enabled
+ */
+void ls2d_engine_update_title(Ls2DEngine *self, Ls2DFrameInfo *frame);
+
 /**
  * Pump any and all drawing events
  */
 void ls2d_engine_draw(Ls2DEngine *self, Ls2DFrameInfo *frame);
 
+/**
+ * Present a frame previously recorded by the simulation thread
+ */
+void ls2d_engine_present_queue(Ls2DEngine *self, Ls2DRenderQueue *queue);
+
+/**
+ * Run the main loop with simulation on a worker thread. The calling
+ * thread owns the renderer and presents recorded frames.
+ */
+int ls2d_engine_run_threaded(Ls2DEngine *self, Ls2DFrameInfo *frame);
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
@@ -0,0 +1,117 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#include "engine-private.h"
+
+/**
+ * Frames sampled per decision, which is also the minimum time between
+ * two changes of scale so that each step can settle before we judge it.
+ */
+#define LS2D_SCALE_WINDOW 30
+
+/**
+ * With vsync, presentation blocks until the display refresh and headroom
+ * can't be measured, so we probe upwards after this many stable frames.
+ */
+#define LS2D_SCALE_PROBE 240
+
+/**
+ * The scale only ever takes values 1.0 - n * LS2D_SCALE_STEP, computed
+ * from the step count, so it can't drift and resize the buffer by a pixel
+ * every few frames.
+ */
+#define LS2D_SCALE_STEP 0.1
+#define LS2D_SCALE_MAX_STEPS 5
+
+/**
+ * Step back up when recent frames use less than this fraction of the
+ * budget. The gap to 1.0 keeps us from flip-flopping around the budget.
+ */
+#define LS2D_SCALE_HEADROOM 0.8
+
+/**
+ * Consecutive windows with headroom needed before stepping back up, so a
+ * single quiet window doesn't immediately undo a step down.
+ */
+#define LS2D_SCALE_CONFIRM 3
+
+void ls2d_engine_update_resolution(Ls2DEngine *self)
+{
+        const Ls2DStatsRing *ring = &self->stats;
+        const uint64_t since = ring->count - self->scale_frame;
+        uint64_t work = 0;
+        int step = self->scale_step;
+
+        if (self->frame_budget == 0 || since < LS2D_SCALE_WINDOW ||
+            ring->count - self->scale_sample < LS2D_SCALE_WINDOW) {
+                return;
+        }
+        self->scale_sample = ring->count;
+
+        /* Pacing delays don't count, only the time spent producing frames */
+        for (uint64_t i = ring->count - LS2D_SCALE_WINDOW; i < ring->count; i++) {
+                const uint32_t index = (uint32_t)(i % LS2D_STATS_SAMPLES);
+                work += ring->update[index] + ring->draw[index];
+        }
+        work /= LS2D_SCALE_WINDOW;
+
+        /* Drop straight away when over budget, but only climb once sure */
+        if (work > self->frame_budget) {
+                self->scale_votes = 0;
+                step++;
+        } else if ((double)work < (double)self->frame_budget * LS2D_SCALE_HEADROOM ||
+                   (self->frame_mode == LS2D_FRAME_MODE_VSYNC && since >= LS2D_SCALE_PROBE)) {
+                if (++self->scale_votes >= LS2D_SCALE_CONFIRM) {
+                        self->scale_votes = 0;
+                        step--;
+                }
+        } else {
+                self->scale_votes = 0;
+        }
+
+        if (step < 0) {
+                step = 0;
+        } else if (step > LS2D_SCALE_MAX_STEPS) {
+                step = LS2D_SCALE_MAX_STEPS;
+        }
+
+        if (step == self->scale_step) {
+                return;
+        }
+        self->scale_step = step;
+        self->render_scale = 1.0 - step * LS2D_SCALE_STEP;
+        self->scale_frame = ring->count;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,113 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine-private.h"
+
+void ls2d_engine_stats_push(Ls2DEngine *self, uint64_t frame, uint64_t update, uint64_t draw)
+{
+        Ls2DStatsRing *ring = &self->stats;
+        const uint32_t index = (uint32_t)(ring->count % LS2D_STATS_SAMPLES);
+
+        ring->frame[index] = frame;
+        ring->update[index] = update;
+        ring->draw[index] = draw;
+        ring->count++;
+}
+
+static int ls2d_engine_stats_compare(const void *a, const void *b)
+{
+        const uint64_t x = *(const uint64_t *)a;
+        const uint64_t y = *(const uint64_t *)b;
+
+        return (x > y) - (x < y);
+}
+
+/**
+ * Sort a copy of the samples so we can pull out the percentiles, leaving
+ * the ring itself untouched.
+ */
+static void ls2d_engine_stats_compute(const uint64_t *samples, uint32_t n_samples,
+                                      Ls2DTimeStats *stats)
+{
+        uint64_t sorted[LS2D_STATS_SAMPLES];
+        uint64_t total = 0;
+
+        memcpy(sorted, samples, n_samples * sizeof(uint64_t));
+        qsort(sorted, n_samples, sizeof(uint64_t), ls2d_engine_stats_compare);
+
+        for (uint32_t i = 0; i < n_samples; i++) {
+                total += sorted[i];
+        }
+
+        stats->min = sorted[0];
+        stats->max = sorted[n_samples - 1];
+        stats->p99 = sorted[((n_samples - 1) * 99) / 100];
+        stats->avg = total / n_samples;
+}
+
+bool ls2d_engine_get_stats(Ls2DEngine *self, Ls2DEngineStats *stats)
+{
+        Ls2DStatsRing *ring = NULL;
+        uint32_t n_samples = 0;
+
+        if (ls_unlikely(!self) || ls_unlikely(!stats)) {
+                return false;
+        }
+
+        memset(stats, 0, sizeof(*stats));
+        ring = &self->stats;
+        stats->frames = ring->count;
+        if (ring->count < 1) {
+                return true;
+        }
+
+        /* Until we wrap, only the head of the ring is populated */
+        n_samples = ring->count < LS2D_STATS_SAMPLES ? (uint32_t)ring->count : LS2D_STATS_SAMPLES;
+        stats->samples = n_samples;
+
+        ls2d_engine_stats_compute(ring->frame, n_samples, &stats->frame);
+        ls2d_engine_stats_compute(ring->update, n_samples, &stats->update);
+        ls2d_engine_stats_compute(ring->draw, n_samples, &stats->draw);
+
+        if (stats->frame.avg > 0) {
+                stats->fps = (double)LS2D_NS_PER_SEC / (double)stats->frame.avg;
+        }
+
+        return true;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,280 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#include <SDL.h>
+#include <string.h>
+
+#include "engine-private.h"
+#include "render-private.h"
+
+/**
+ * Input events buffered between the render thread polling them and the
+ * simulation thread consuming them. Anything beyond this is dropped.
+ */
+#define LS2D_THREAD_EVENTS 256
+
+#define LS2D_THREAD_NO_QUEUE -1
+
+/**
+ * State shared between the render (calling) thread and the simulation
+ * thread. The simulation records into one queue while the other is being
+ * presented, and may run at most one frame ahead.
+ */
+typedef struct Ls2DEngineThread {
+        Ls2DEngine *engine;
+        Ls2DFrameInfo frame; /**<Simulation thread's own frame clock */
+        Ls2DRenderQueue *queues[2];
+
+        /* Everything below is guarded by the lock */
+        SDL_mutex *lock;
+        SDL_cond *cond;
+        int ready;      /**<Queue waiting to be presented */
+        int presenting; /**<Queue currently being presented */
+        SDL_Event events[LS2D_THREAD_EVENTS];
+        uint32_t n_events;
+} Ls2DEngineThread;
+
+static bool ls2d_engine_thread_init(Ls2DEngineThread *self, Ls2DEngine *engine,
+                                    Ls2DFrameInfo *frame)
+{
+        self->engine = engine;
+        self->frame = *frame;
+        self->ready = LS2D_THREAD_NO_QUEUE;
+        self->presenting = LS2D_THREAD_NO_QUEUE;
+
+        for (int i = 0; i < 2; i++) {
+                self->queues[i] = ls2d_render_queue_new();
+                if (ls_unlikely(!self->queues[i])) {
+                        return false;
+                }
+        }
+
+        self->lock = SDL_CreateMutex();
+        self->cond = SDL_CreateCond();
+        return self->lock != NULL && self->cond != NULL;
+}
+
+static void ls2d_engine_thread_deinit(Ls2DEngineThread *self)
+{
+        for (int i = 0; i < 2; i++) {
+                ls2d_render_queue_free(self->queues[i]);
+        }
+        if (self->cond != NULL) {
+                SDL_DestroyCond(self->cond);
+        }
+        if (self->lock != NULL) {
+                SDL_DestroyMutex(self->lock);
+        }
+}
+
+/**
+ * Stop both threads, waking whichever one may be waiting on the other
+ */
+static void ls2d_engine_thread_stop(Ls2DEngineThread *self)
+{
+        SDL_LockMutex(self->lock);
+        self->engine->running = false;
+        SDL_CondBroadcast(self->cond);
+        SDL_UnlockMutex(self->lock);
+}
+
+/**
+ * Only the render thread may touch the window, so engine-level events are
+ * handled here and everything is then forwarded to the input manager on
+ * the simulation thread.
+ */
+static void ls2d_engine_thread_poll_events(Ls2DEngineThread *self, Ls2DFrameInfo *frame)
+{
+        Ls2DEngine *engine = self->engine;
+        SDL_Event event = { 0 };
+
+        SDL_LockMutex(self->lock);
+        while (SDL_PollEvent(&event) != 0) {
+                if (engine->recorder != NULL) {
+                        ls2d_replay_add_event(engine->recorder, frame->ticks, &event);
+                }
+                ls2d_engine_handle_event(engine, &event);
+                if (ls_likely(self->n_events < LS2D_THREAD_EVENTS)) {
+                        self->events[self->n_events++] = event;
+                }
+        }
+        SDL_UnlockMutex(self->lock);
+}
+
+static int ls2d_engine_thread_simulate(void *data)
+{
+        Ls2DEngineThread *self = data;
+        Ls2DEngine *engine = self->engine;
+        Ls2DFrameInfo *frame = &self->frame;
+        SDL_Event events[LS2D_THREAD_EVENTS];
+        uint32_t n_events = 0;
+        int index = 0;
+
+        while (engine->running) {
+                Ls2DRenderQueue *queue = NULL;
+                uint64_t update_start, draw_start;
+
+                /* Wait for the last frame to be picked up, and our queue to be free */
+                SDL_LockMutex(self->lock);
+                while (engine->running && (self->ready != LS2D_THREAD_NO_QUEUE ||
+                                           self->presenting == index)) {
+                        SDL_CondWait(self->cond, self->lock);
+                }
+                n_events = self->n_events;
+                memcpy(events, self->events, n_events * sizeof(SDL_Event));
+                self->n_events = 0;
+                SDL_UnlockMutex(self->lock);
+
+                if (!engine->running) {
+                        break;
+                }
+
+                queue = self->queues[index];
+                ls2d_render_queue_reset(queue);
+                frame->queue = queue;
+
+                ls2d_frame_info_tick(frame);
+
+                update_start = ls2d_frame_info_now(frame);
+                for (uint32_t i = 0; i < n_events; i++) {
+                        ls2d_input_manager_process(engine->input_manager, &events[i], frame);
+                }
+                ls2d_engine_update(engine, frame);
+
+                /* Record the frame for presentation */
+                draw_start = ls2d_frame_info_now(frame);
+                if (ls_likely(engine->active_scene != NULL)) {
+                        ls2d_scene_draw(engine->active_scene, frame);
+                }
+                queue->update = draw_start - update_start;
+                queue->draw = ls2d_frame_info_now(frame) - draw_start;
+
+                ls2d_frame_info_stash(frame);
+
+                SDL_LockMutex(self->lock);
+                self->ready = index;
+                SDL_CondBroadcast(self->cond);
+                SDL_UnlockMutex(self->lock);
+
+                index = 1 - index;
+        }
+
+        /* Make sure the render thread isn't left waiting on us */
+        SDL_LockMutex(self->lock);
+        SDL_CondBroadcast(self->cond);
+        SDL_UnlockMutex(self->lock);
+
+        return 0;
+}
+
+int ls2d_engine_run_threaded(Ls2DEngine *self, Ls2DFrameInfo *frame)
+{
+        Ls2DEngineThread thread = { 0 };
+        SDL_Thread *simulation = NULL;
+
+        if (!ls2d_engine_thread_init(&thread, self, frame)) {
+                SDL_LogCritical(SDL_LOG_CATEGORY_APPLICATION, "Couldn't set up threading");
+                goto fail;
+        }
+
+        simulation = SDL_CreateThread(ls2d_engine_thread_simulate, "ls2d-simulation", &thread);
+        if (!simulation) {
+                SDL_LogCritical(SDL_LOG_CATEGORY_APPLICATION,
+                                "Couldn't create simulation thread: %s",
+                                SDL_GetError());
+                goto fail;
+        }
+
+        while (self->running) {
+                Ls2DRenderQueue *queue = NULL;
+                uint64_t update, draw, present_start;
+                int index;
+
+                ls2d_frame_info_tick(frame);
+                ls2d_engine_thread_poll_events(&thread, frame);
+
+                /* Take the most recently recorded frame */
+                SDL_LockMutex(thread.lock);
+                while (self->running && thread.ready == LS2D_THREAD_NO_QUEUE) {
+                        SDL_CondWait(thread.cond, thread.lock);
+                }
+                index = thread.ready;
+                thread.ready = LS2D_THREAD_NO_QUEUE;
+                thread.presenting = index;
+                SDL_CondBroadcast(thread.cond);
+                SDL_UnlockMutex(thread.lock);
+
+                if (index == LS2D_THREAD_NO_QUEUE) {
+                        break;
+                }
+
+                /* Simulation now overlaps with presentation */
+                queue = thread.queues[index];
+                present_start = ls2d_frame_info_now(frame);
+                ls2d_engine_present_queue(self, queue);
+                update = queue->update;
+                draw = queue->draw + (ls2d_frame_info_now(frame) - present_start);
+
+                SDL_LockMutex(thread.lock);
+                thread.presenting = LS2D_THREAD_NO_QUEUE;
+                SDL_CondBroadcast(thread.cond);
+                SDL_UnlockMutex(thread.lock);
+
+                ls2d_frame_info_stash(frame);
+                ls2d_engine_stats_push(self, frame->tick_increment, update, draw);
+                ls2d_engine_update_resolution(self);
+                ls2d_engine_update_title(self, frame);
+                ls2d_engine_process_preload(self);
+
+                if (self->frame_mode == LS2D_FRAME_MODE_CAPPED && self->frame_time > 0) {
+                        ls2d_frame_info_delay(frame, self->frame_time);
+                }
+
+                if (self->frame_limit > 0 && frame->i_frame >= self->frame_limit) {
+                        break;
+                }
+        }
+
+        ls2d_engine_thread_stop(&thread);
+        SDL_WaitThread(simulation, NULL);
+        ls2d_engine_thread_deinit(&thread);
+        return EXIT_SUCCESS;
+
+fail:
+        self->running = false;
+        ls2d_engine_thread_deinit(&thread);
+        return EXIT_FAILURE;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
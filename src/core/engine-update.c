@@ -24,6 +24,7 @@
 #include <SDL.h>
 
 #include "engine-private.h"
+#include "replay-private.h"
 #include "libls.h"
 
 static void ls2d_engine_process_keyboard(Ls2DEngine *self, SDL_KeyboardEvent *event)
@@ -49,33 +50,94 @@ static void ls2d_engine_process_keyboard(Ls2DEngine *self, SDL_KeyboardEvent *ev
         return;
 }
 
-void ls2d_engine_process_events(Ls2DEngine *self, Ls2DFrameInfo *frame)
+void ls2d_engine_dispatch_event(Ls2DEngine *self, SDL_Event *event, Ls2DFrameInfo *frame)
 {
-        SDL_Event event = { 0 };
+        /* Process input if we can. */
+        if (ls2d_input_manager_process(self->input_manager, event, frame)) {
+                return;
+        }
 
-        if (ls_likely(self->active_scene != NULL)) {
-                ls2d_scene_update(self->active_scene, frame);
+        ls2d_engine_handle_event(self, event);
+}
+
+void ls2d_engine_handle_event(Ls2DEngine *self, SDL_Event *event)
+{
+        switch (event->type) {
+        case SDL_KEYUP:
+        case SDL_KEYDOWN:
+                ls2d_engine_process_keyboard(self, &(event->key));
+                break;
+        case SDL_QUIT:
+                self->running = false;
+                break;
+        default:
+                break;
         }
+}
+
+void ls2d_engine_process_events(Ls2DEngine *self, Ls2DFrameInfo *frame)
+{
+        SDL_Event event = { 0 };
+        LS2D_PROFILE_FUNC();
 
         /* Event update */
         while (SDL_PollEvent(&event) != 0) {
-                /* Process input if we can. */
-                if (ls2d_input_manager_process(self->input_manager, &event, frame)) {
-                        continue;
+                if (self->recorder != NULL) {
+                        ls2d_replay_add_event(self->recorder, frame->ticks, &event);
                 }
+                ls2d_engine_dispatch_event(self, &event, frame);
+        }
+}
 
-                switch (event.type) {
-                case SDL_KEYUP:
-                case SDL_KEYDOWN:
-                        ls2d_engine_process_keyboard(self, &(event.key));
-                        break;
-                case SDL_QUIT:
+void ls2d_engine_process_replay(Ls2DEngine *self, Ls2DReplay *replay, Ls2DFrameInfo *frame)
+{
+        SDL_Event event = { 0 };
+        Ls2DReplayEvent *record = NULL;
+
+        /* Live input must not leak into the replay, but honour quit requests */
+        while (SDL_PollEvent(&event) != 0) {
+                if (event.type == SDL_QUIT) {
                         self->running = false;
-                        break;
-                default:
-                        break;
                 }
         }
+
+        while ((record = ls2d_replay_next_event(replay, frame->ticks)) != NULL) {
+                ls2d_engine_dispatch_event(self, &record->event, frame);
+        }
+}
+
+void ls2d_engine_update(Ls2DEngine *self, Ls2DFrameInfo *frame)
+{
+        const uint64_t elapsed = frame->tick_increment;
+        const uint64_t max_accumulator = self->tick_step * LS2D_MAX_TICKS_PER_FRAME;
+        LS2D_PROFILE_FUNC();
+
+        if (ls_unlikely(!self->active_scene)) {
+                return;
+        }
+
+        /* Variable step, update once per frame */
+        if (self->tick_step == 0) {
+                frame->alpha = 1.0;
+                ls2d_scene_update(self->active_scene, frame);
+                return;
+        }
+
+        /* Drop time we can't catch up on rather than stalling further */
+        self->tick_accumulator += elapsed;
+        if (self->tick_accumulator > max_accumulator) {
+                self->tick_accumulator = max_accumulator;
+        }
+
+        /* Simulation only ever sees the fixed step */
+        frame->tick_increment = self->tick_step;
+        while (self->tick_accumulator >= self->tick_step) {
+                ls2d_scene_update(self->active_scene, frame);
+                self->tick_accumulator -= self->tick_step;
+        }
+        frame->tick_increment = elapsed;
+
+        frame->alpha = (double)self->tick_accumulator / (double)self->tick_step;
 }
 
 /*
@@ -29,6 +29,8 @@
 #include <stdlib.h>
 
 #include "engine-private.h"
+#include "render-private.h"
+#include "replay-private.h"
 
 static bool did_init_xml = false;
 static bool did_init_sdl = false;
@@ -70,7 +72,76 @@ fail:
         return 0;
 }
 
-Ls2DEngine *ls2d_engine_new(int width, int height)
+/**
+ * Set up a visible window with an accelerated renderer
+ */
+static bool ls2d_engine_init_display(Ls2DEngine *self)
+{
+        /* Setup the window */
+        self->window = SDL_CreateWindow("lispysnake2d",
+                                        SDL_WINDOWPOS_UNDEFINED,
+                                        SDL_WINDOWPOS_UNDEFINED,
+                                        self->width,
+                                        self->height,
+                                        SDL_WINDOW_HIDDEN | SDL_WINDOW_ALLOW_HIGHDPI);
+        if (!self->window) {
+                SDL_LogCritical(SDL_LOG_CATEGORY_VIDEO,
+                                "Couldn't create window: %s",
+                                SDL_GetError());
+                return false;
+        }
+
+        /* Setup our renderer, vsync is controlled by the frame mode. */
+        self->render = SDL_CreateRenderer(self->window,
+                                          -1,
+                                          SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
+        if (!self->render) {
+                SDL_LogCritical(SDL_LOG_CATEGORY_VIDEO,
+                                "Couldn't create a renderer: %s",
+                                SDL_GetError());
+                return false;
+        }
+
+        /* autoset fps cap */
+        ls2d_engine_set_fps_cap(self, ls2d_get_framerate());
+        ls2d_engine_set_frame_mode(self, LS2D_FRAME_MODE_VSYNC);
+
+        return true;
+}
+
+/**
+ * Set up an offscreen software renderer with no window at all
+ */
+static bool ls2d_engine_init_headless(Ls2DEngine *self)
+{
+        self->surface = SDL_CreateRGBSurfaceWithFormat(0,
+                                                       self->width,
+                                                       self->height,
+                                                       32,
+                                                       SDL_PIXELFORMAT_RGBA8888);
+        if (!self->surface) {
+                SDL_LogCritical(SDL_LOG_CATEGORY_VIDEO,
+                                "Couldn't create offscreen surface: %s",
+                                SDL_GetError());
+                return false;
+        }
+
+        self->render = SDL_CreateSoftwareRenderer(self->surface);
+        if (!self->render) {
+                SDL_LogCritical(SDL_LOG_CATEGORY_VIDEO,
+                                "Couldn't create a software renderer: %s",
+                                SDL_GetError());
+                return false;
+        }
+
+        /* Nothing to sync to, run flat out */
+        ls2d_engine_set_fps_cap(self, 0);
+        ls2d_engine_set_frame_mode(self, LS2D_FRAME_MODE_UNCAPPED);
+
+        return true;
+}
+
+static Ls2DEngine *ls2d_engine_new_internal(int width, int height, bool headless)
 {
         Ls2DEngine *engine = NULL;
 
@@ -81,7 +152,7 @@ Ls2DEngine *ls2d_engine_new(int width, int height)
                 return NULL;
         }
 
-        engine = calloc(1, sizeof(struct Ls2DEngine));
+        engine = LS2D_NEW(Ls2DEngine, engine_vtable);
         if (!engine) {
                 return NULL;
         }
@@ -90,60 +161,42 @@ Ls2DEngine *ls2d_engine_new(int width, int height)
         engine->height = height;
         engine->running = false;
         engine->fullscreen = false;
-
-        /* autoset fps cap */
-        engine->fps_delay = ls2d_get_framerate();
-
-        /* Setup the window */
-        engine->window = SDL_CreateWindow("lispysnake2d",
-                                          SDL_WINDOWPOS_UNDEFINED,
-                                          SDL_WINDOWPOS_UNDEFINED,
-                                          width,
-                                          height,
-                                          SDL_WINDOW_HIDDEN | SDL_WINDOW_ALLOW_HIGHDPI);
-        if (!engine->window) {
-                SDL_LogCritical(SDL_LOG_CATEGORY_VIDEO,
-                                "Couldn't create window: %s",
-                                SDL_GetError());
-                ls2d_engine_destroy(engine);
-                return NULL;
-        }
-
-        /* Setup our renderer, lock vsync for now. */
-        engine->render = SDL_CreateRenderer(engine->window,
-                                            -1,
-                                            SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC |
-                                                SDL_RENDERER_TARGETTEXTURE);
-        if (!engine->render) {
-                SDL_LogCritical(SDL_LOG_CATEGORY_VIDEO,
-                                "Couldn't create a renderer: %s",
-                                SDL_GetError());
-                ls2d_engine_destroy(engine);
+        engine->headless = headless;
+        engine->direct_render = true;
+        engine->render_scale = 1.0;
+        engine->show_fps = !headless;
+
+        if (headless) {
+                if (!ls2d_engine_init_headless(engine)) {
+                        ls2d_engine_unref(engine);
+                        return NULL;
+                }
+        } else if (!ls2d_engine_init_display(engine)) {
+                ls2d_engine_unref(engine);
                 return NULL;
         }
         SDL_RenderSetLogicalSize(engine->render, width, height);
 
-        engine->buffer = SDL_CreateTexture(engine->render,
-                                           SDL_PIXELFORMAT_RGBA8888,
-                                           SDL_TEXTUREACCESS_TARGET,
-                                           width,
-                                           height);
-        if (ls_unlikely(!engine->buffer)) {
-                SDL_LogCritical(SDL_LOG_CATEGORY_VIDEO,
-                                "Couldn't create double buffer: %s\n",
-                                SDL_GetError());
-                ls2d_engine_destroy(engine);
-                return NULL;
-        }
-
         engine->input_manager = ls2d_input_manager_new();
         if (!engine->input_manager) {
                 SDL_LogCritical(SDL_LOG_CATEGORY_INPUT, "Couldn't create InputManager");
-                ls2d_engine_destroy(engine);
+                ls2d_engine_unref(engine);
                 return NULL;
         }
 
-        return ls2d_object_init((Ls2DObject *)engine, &engine_vtable);
+        return engine;
+}
+
+Ls2DEngine *ls2d_engine_new(int width, int height)
+{
+        return ls2d_engine_new_internal(width, height, false);
+}
+
+Ls2DEngine *ls2d_engine_new_headless(int width, int height)
+{
+        /* Ensure SDL never goes looking for a real display */
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+        return ls2d_engine_new_internal(width, height, true);
 }
 
 Ls2DEngine *ls2d_engine_new_current_display()
@@ -173,7 +226,17 @@ Ls2DEngine *ls2d_engine_new_current_display()
 
 Ls2DEngine *ls2d_engine_unref(Ls2DEngine *self)
 {
-        return ls2d_object_unref(self);
+        if (ls_unlikely(!self)) {
+                return NULL;
+        }
+        self = ls2d_object_unref(self);
+#ifdef LS2D_ENABLE_OBJECT_STATS
+        /* Engine is gone too, so anything still live now has leaked */
+        if (!self) {
+                ls2d_object_stats_dump(stderr);
+        }
+#endif
+        return self;
 }
 
 static inline void free_scene(void *v)
@@ -186,6 +249,7 @@ static void ls2d_engine_destroy(Ls2DEngine *self)
         if (ls_unlikely(!self)) {
                 goto cleanup;
         }
+        ls2d_engine_preload_clear(self);
         if (ls_likely(self->game != NULL) && ls_likely(self->game->funcs.destroy != NULL)) {
                 self->game->funcs.destroy(self->game);
         }
@@ -195,13 +259,22 @@ static void ls2d_engine_destroy(Ls2DEngine *self)
         if (ls_likely(self->window != NULL)) {
                 SDL_DestroyWindow(self->window);
         }
+        if (self->surface != NULL) {
+                SDL_FreeSurface(self->surface);
+        }
         if (ls_likely(self->scenes != NULL)) {
                 ls_list_free_full(self->scenes, free_scene);
         }
         if (ls_likely(self->input_manager != NULL)) {
                 ls2d_input_manager_unref(self->input_manager);
         }
-        free(self);
+        if (self->recorder != NULL) {
+                ls2d_replay_unref(self->recorder);
+        }
+        if (self->jobs != NULL) {
+                ls2d_job_pool_free(self->jobs);
+        }
+        ls2d_render_queue_free(self->queue);
 
 cleanup:
         sdl_deinit();
@@ -209,64 +282,174 @@ cleanup:
 }
 
 /**
- * Internally we're responsible for the primary event queue, so we'll
- * manage it here and if necessary dispatch it.
+ * Refresh the window title with the framerate, rate limited so that we're
+ * not talking to the window manager every frame.
  */
-int ls2d_engine_run(Ls2DEngine *self, Ls2DGame *game)
+void ls2d_engine_update_title(Ls2DEngine *self, Ls2DFrameInfo *frame)
 {
-        Ls2DFrameInfo frame = { 0 };
-        if (ls_unlikely(!self)) {
-                return EXIT_FAILURE;
+        Ls2DEngineStats stats = { 0 };
+        char title[64] = { 0 };
+
+        if (!self->show_fps || ls_unlikely(!frame->window)) {
+                return;
+        }
+        if (frame->ticks - self->title_ticks < LS2D_TITLE_INTERVAL_NS) {
+                return;
+        }
+        self->title_ticks = frame->ticks;
+
+        if (!ls2d_engine_get_stats(self, &stats)) {
+                return;
         }
+        snprintf(title, sizeof(title), "demo: %.1f/fps", stats.fps);
+        SDL_SetWindowTitle(frame->window, title);
+}
+
+/**
+ * Attach the game and get it initialised, ready for the first frame
+ */
+static bool ls2d_engine_start(Ls2DEngine *self, Ls2DGame *game, Ls2DFrameInfo *frame)
+{
         if (ls_unlikely(!game)) {
                 fprintf(stderr, "Missing game!\n");
-                return EXIT_FAILURE;
+                return false;
         }
 
         game->engine = self;
         self->game = game;
 
         /* Make sure to show the window */
-        SDL_ShowWindow(self->window);
+        if (ls_likely(self->window != NULL)) {
+                SDL_ShowWindow(self->window);
+        }
 
         /* Get the ball rolling */
         self->running = true;
-        ls2d_frame_info_init(&frame);
 
-        frame.window = self->window;
-        frame.renderer = self->render;
+        frame->window = self->window;
+        frame->renderer = self->render;
+        frame->jobs = self->jobs;
 
         if (game->funcs.init) {
                 if (!game->funcs.init(game)) {
                         fprintf(stderr, "Game init failed\n");
-                        return EXIT_FAILURE;
+                        return false;
                 }
         }
 
+        /* Start the clock after init so loading doesn't count as a frame */
+        ls2d_frame_info_init(frame);
+        return true;
+}
+
+/**
+ * Internally we're responsible for the primary event queue, so we'll
+ * manage it here and if necessary dispatch it.
+ */
+int ls2d_engine_run(Ls2DEngine *self, Ls2DGame *game)
+{
+        Ls2DFrameInfo frame = { 0 };
+        if (ls_unlikely(!self)) {
+                return EXIT_FAILURE;
+        }
+        if (!ls2d_engine_start(self, game, &frame)) {
+                return EXIT_FAILURE;
+        }
+        if (self->threaded) {
+                return ls2d_engine_run_threaded(self, &frame);
+        }
+
         /* Primary event loop */
         while (self->running) {
+                uint64_t update_start, draw_start, draw_end;
+
                 /* Update frameinfo */
                 ls2d_frame_info_tick(&frame);
 
+                update_start = ls2d_frame_info_now(&frame);
                 ls2d_engine_process_events(self, &frame);
+                ls2d_engine_update(self, &frame);
+
+                draw_start = ls2d_frame_info_now(&frame);
                 ls2d_engine_draw(self, &frame);
+                draw_end = ls2d_frame_info_now(&frame);
 
                 /* Stash ticks */
                 ls2d_frame_info_stash(&frame);
+                ls2d_engine_stats_push(self,
+                                       frame.tick_increment,
+                                       draw_start - update_start,
+                                       draw_end - draw_start);
+                ls2d_engine_update_resolution(self);
+                ls2d_engine_update_title(self, &frame);
+                ls2d_engine_process_preload(self);
+
+                /* If framerate cap is set, use it. */
+                if (self->frame_mode == LS2D_FRAME_MODE_CAPPED && self->frame_time > 0) {
+                        ls2d_frame_info_delay(&frame, self->frame_time);
+                }
+
+                if (self->frame_limit > 0 && frame.i_frame >= self->frame_limit) {
+                        self->running = false;
+                }
+        }
+
+        return EXIT_SUCCESS;
+}
+
+int ls2d_engine_run_replay(Ls2DEngine *self, Ls2DGame *game, Ls2DReplay *replay,
+                           uint32_t n_frames)
+{
+        Ls2DFrameInfo frame = { 0 };
+        const uint64_t step = self && self->tick_step > 0 ? self->tick_step : LS2D_REPLAY_STEP_NS;
+
+        if (ls_unlikely(!self) || ls_unlikely(!replay)) {
+                return EXIT_FAILURE;
+        }
+        if (!ls2d_replay_reset(replay)) {
+                return EXIT_FAILURE;
+        }
+        if (!ls2d_engine_start(self, game, &frame)) {
+                return EXIT_FAILURE;
+        }
+
+        for (uint32_t i = 0; i < n_frames && self->running; i++) {
+                uint64_t update_start, draw_start, draw_end;
 
-                double fps = ls2d_frame_info_get_fps(&frame);
-                char *s = NULL;
-                asprintf(&s, "demo: %.1f/fps", fps);
-                SDL_SetWindowTitle(frame.window, s);
-                free(s);
+                /* Simulation sees a perfectly steady clock */
+                ls2d_frame_info_advance(&frame, step);
+
+                update_start = ls2d_frame_info_now(&frame);
+                ls2d_engine_process_replay(self, replay, &frame);
+                ls2d_engine_update(self, &frame);
+
+                draw_start = ls2d_frame_info_now(&frame);
+                ls2d_engine_draw(self, &frame);
+                draw_end = ls2d_frame_info_now(&frame);
 
-                /* If framerate cap is set, use it.
-                ls2d_frame_info_delay(&frame, self->fps_delay, fps);*/
+                ls2d_frame_info_stash(&frame);
+                ls2d_replay_push_timing(replay, draw_start - update_start, draw_end - draw_start);
+                ls2d_engine_stats_push(self,
+                                       draw_end - update_start,
+                                       draw_start - update_start,
+                                       draw_end - draw_start);
         }
 
+        self->running = false;
         return EXIT_SUCCESS;
 }
 
+void ls2d_engine_set_recorder(Ls2DEngine *self, Ls2DReplay *replay)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        if (self->recorder != NULL) {
+                ls2d_replay_unref(self->recorder);
+        }
+        self->recorder = replay ? ls2d_object_ref(replay) : NULL;
+}
+
 void ls2d_engine_set_fullscreen(Ls2DEngine *self, bool fullscreen)
 {
         if (!self || !self->window) {
@@ -282,7 +465,133 @@ void ls2d_engine_set_fps_cap(Ls2DEngine *self, uint32_t fps)
         if (ls_unlikely(!self)) {
                 return;
         }
-        self->fps_delay = fps;
+        self->frame_time = fps > 0 ? LS2D_NS_PER_SEC / fps : 0;
+}
+
+void ls2d_engine_set_frame_mode(Ls2DEngine *self, Ls2DFrameMode mode)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        if (self->headless && mode == LS2D_FRAME_MODE_VSYNC) {
+                SDL_LogWarn(SDL_LOG_CATEGORY_RENDER, "No display to sync to, running uncapped");
+                mode = LS2D_FRAME_MODE_UNCAPPED;
+        }
+        self->frame_mode = mode;
+        if (ls_unlikely(!self->render) || self->headless) {
+                return;
+        }
+        if (SDL_RenderSetVSync(self->render, mode == LS2D_FRAME_MODE_VSYNC ? 1 : 0) != 0) {
+                SDL_LogError(SDL_LOG_CATEGORY_RENDER,
+                             "Couldn't change vsync state: %s",
+                             SDL_GetError());
+        }
+}
+
+void ls2d_engine_set_tick_rate(Ls2DEngine *self, uint32_t rate)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        self->tick_step = rate > 0 ? LS2D_NS_PER_SEC / rate : 0;
+        self->tick_accumulator = 0;
+}
+
+void ls2d_engine_set_frame_limit(Ls2DEngine *self, uint64_t frames)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        self->frame_limit = frames;
+}
+
+void ls2d_engine_set_threaded(Ls2DEngine *self, bool threaded)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        if (self->running) {
+                SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Cannot change threading while running");
+                return;
+        }
+        self->threaded = threaded;
+}
+
+void ls2d_engine_set_worker_threads(Ls2DEngine *self, int n_workers)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        if (self->running) {
+                SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Cannot change worker threads while running");
+                return;
+        }
+        if (n_workers < 0) {
+                n_workers = SDL_GetCPUCount() - 1;
+        }
+
+        ls2d_job_pool_free(self->jobs);
+        self->jobs = NULL;
+        if (n_workers > 0) {
+                self->jobs = ls2d_job_pool_new((uint32_t)n_workers);
+        }
+}
+
+void ls2d_engine_set_direct_render(Ls2DEngine *self, bool direct)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        self->direct_render = direct;
+
+        /* Drop the offscreen buffer until something needs it again */
+        if (!ls2d_engine_needs_buffer(self) && self->buffer != NULL) {
+                SDL_DestroyTexture(self->buffer);
+                self->buffer = NULL;
+        }
+}
+
+void ls2d_engine_set_dynamic_resolution(Ls2DEngine *self, uint64_t budget)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        self->frame_budget = budget;
+        self->render_scale = 1.0;
+        self->scale_step = 0;
+        self->scale_votes = 0;
+        self->scale_frame = self->stats.count;
+        self->scale_sample = self->stats.count;
+
+        if (!ls2d_engine_needs_buffer(self) && self->buffer != NULL) {
+                SDL_DestroyTexture(self->buffer);
+                self->buffer = NULL;
+        }
+}
+
+double ls2d_engine_get_render_scale(Ls2DEngine *self)
+{
+        if (ls_unlikely(!self)) {
+                return 1.0;
+        }
+        return self->render_scale;
+}
+
+void ls2d_engine_set_show_fps(Ls2DEngine *self, bool show_fps)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        self->show_fps = show_fps;
+}
+
+/**
+ * A scene may only run once any preload of it has finished
+ */
+static bool ls2d_engine_scene_ready(Ls2DEngine *self, Ls2DScene *scene)
+{
+        return scene != self->preload.scene ||
+               atomic_load(&self->preload.state) == LS2D_PRELOAD_READY;
 }
 
 void ls2d_engine_add_scene(Ls2DEngine *self, Ls2DScene *scene)
@@ -292,11 +601,27 @@ void ls2d_engine_add_scene(Ls2DEngine *self, Ls2DScene *scene)
                 return;
         }
         self->scenes = ls_list_append(self->scenes, ls2d_object_ref(scene));
-        if (!self->active_scene) {
+        if (!self->active_scene && ls2d_engine_scene_ready(self, scene)) {
                 self->active_scene = scene;
         }
 }
 
+bool ls2d_engine_set_active_scene(Ls2DEngine *self, Ls2DScene *scene)
+{
+        if (ls_unlikely(!self) || ls_unlikely(!scene)) {
+                return false;
+        }
+
+        /* The preload worker or uploads may still be using it */
+        if (!ls2d_engine_scene_ready(self, scene)) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+                             "Can't switch to a scene before its preload is ready");
+                return false;
+        }
+        self->active_scene = scene;
+        return true;
+}
+
 Ls2DInputManager *ls2d_engine_get_input_manager(Ls2DEngine *self)
 {
         if (ls_unlikely(!self)) {
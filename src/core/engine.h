@@ -27,11 +27,45 @@
 
 #include "ls2d.h"
 
+/**
+ * Ls2DFrameMode determines how the engine paces the presentation of frames.
+ */
+typedef enum Ls2DFrameMode {
+        LS2D_FRAME_MODE_VSYNC = 0, /**<Presentation waits for the display refresh */
+        LS2D_FRAME_MODE_CAPPED,    /**<Frames are limited to the fps cap */
+        LS2D_FRAME_MODE_UNCAPPED,  /**<Frames are produced as fast as possible */
+} Ls2DFrameMode;
+
+/**
+ * Ls2DPreloadState tracks the progress of ls2d_engine_preload_scene.
+ */
+typedef enum Ls2DPreloadState {
+        LS2D_PRELOAD_IDLE = 0,  /**<Nothing has been preloaded */
+        LS2D_PRELOAD_LOADING,   /**<The loader function is running */
+        LS2D_PRELOAD_DECODING,  /**<Images are being decoded */
+        LS2D_PRELOAD_UPLOADING, /**<Textures are being uploaded, a few per frame */
+        LS2D_PRELOAD_READY,     /**<The scene can be switched to without loading */
+        LS2D_PRELOAD_FAILED,    /**<The loader function returned false */
+} Ls2DPreloadState;
+
+/**
+ * Populate a scene (entities, tilemaps, texture handles) away from the
+ * main thread. Return false to fail the preload.
+ */
+typedef bool (*ls2d_engine_preload_func)(Ls2DScene *scene, void *userdata);
+
 /**
  * Return a new Ls2DEngine object
  */
 Ls2DEngine *ls2d_engine_new(int width, int height);
 
+/**
+ * Return a new Ls2DEngine object that renders offscreen in software, with
+ * no window and no vsync. This is intended for benchmarking the update
+ * and draw paths on machines without a display or GPU.
+ */
+Ls2DEngine *ls2d_engine_new_headless(int width, int height);
+
 /**
  * Return a new Ls2DEngine object for the current display size
  */
@@ -49,6 +83,22 @@ Ls2DEngine *ls2d_engine_unref(Ls2DEngine *self);
  */
 int ls2d_engine_run(Ls2DEngine *self, Ls2DGame *game);
 
+/**
+ * Run an Ls2DEngine for exactly n_frames, feeding it the events recorded
+ * in replay instead of live input. Frames are stepped with a synthetic
+ * clock (the tick rate if set, or 60Hz) so that every run simulates the
+ * same thing, and the real update/draw timings of each frame are stored
+ * in the replay for reporting.
+ */
+int ls2d_engine_run_replay(Ls2DEngine *self, Ls2DGame *game, Ls2DReplay *replay,
+                           uint32_t n_frames);
+
+/**
+ * Record all live events into replay, timestamped against the frame
+ * clock. Pass NULL to stop recording.
+ */
+void ls2d_engine_set_recorder(Ls2DEngine *self, Ls2DReplay *replay);
+
 /**
  * Update the fullscreen state of the display
  */
@@ -56,14 +106,102 @@ void ls2d_engine_set_fullscreen(Ls2DEngine *self, bool fullscreen);
 
 /**
  * Set a framerate cap on the engine. If set to 0, there will be no cap.
+ * The cap is only enforced in LS2D_FRAME_MODE_CAPPED, and defaults to
+ * the refresh rate of the display.
  */
 void ls2d_engine_set_fps_cap(Ls2DEngine *self, uint32_t fps);
 
+/**
+ * Select how frames are paced: by vsync, by the fps cap, or not at all.
+ */
+void ls2d_engine_set_frame_mode(Ls2DEngine *self, Ls2DFrameMode mode);
+
+/**
+ * Set a fixed simulation tick rate in Hz. The active scene will then be
+ * updated at this rate regardless of the render rate, and drawing will
+ * receive the interpolation alpha via Ls2DFrameInfo.
+ * If set to 0, the scene is updated once per rendered frame.
+ */
+void ls2d_engine_set_tick_rate(Ls2DEngine *self, uint32_t rate);
+
+/**
+ * Stop ls2d_engine_run after the given number of frames. If set to 0,
+ * the engine runs until it is asked to quit.
+ */
+void ls2d_engine_set_frame_limit(Ls2DEngine *self, uint64_t frames);
+
+/**
+ * Fill stats with the timings of recent frames. This is cheap enough to
+ * call a few times per second, but shouldn't be called every frame.
+ */
+bool ls2d_engine_get_stats(Ls2DEngine *self, Ls2DEngineStats *stats);
+
+/**
+ * Show the current framerate in the window title. It is refreshed at
+ * most a few times per second. Enabled by default.
+ */
+void ls2d_engine_set_show_fps(Ls2DEngine *self, bool show_fps);
+
+/**
+ * When threaded, scene update and draw run on a worker thread which
+ * records draw calls for this thread to present. Replays always run
+ * on a single thread.
+ */
+void ls2d_engine_set_threaded(Ls2DEngine *self, bool threaded);
+
+/**
+ * Spread scene updates over n_workers threads in addition to the one
+ * running the simulation. Pass -1 for one per spare CPU, or 0 (the
+ * default) to update everything on a single thread.
+ */
+void ls2d_engine_set_worker_threads(Ls2DEngine *self, int n_workers);
+
+/**
+ * Direct rendering (the default) draws straight to the default target.
+ * Disabling it renders the scene to an offscreen buffer which is then
+ * copied to the screen. Call this from the thread running the engine.
+ */
+void ls2d_engine_set_direct_render(Ls2DEngine *self, bool direct);
+
+/**
+ * Render the scene at a reduced internal resolution, upscaled at present,
+ * whenever recent frames take longer than budget nanoseconds to produce.
+ * The resolution steps back up once there is headroom. 0 disables.
+ */
+void ls2d_engine_set_dynamic_resolution(Ls2DEngine *self, uint64_t budget);
+
+/**
+ * Fraction of the logical size the scene is currently rendered at
+ */
+double ls2d_engine_get_render_scale(Ls2DEngine *self);
+
 /**
  * Add a new scene to the Ls2DEngine.
  */
 void ls2d_engine_add_scene(Ls2DEngine *self, Ls2DScene *scene);
 
+/**
+ * Switch the active scene to one previously added with ls2d_engine_add_scene.
+ * A scene being preloaded can't be switched to until its preload state is
+ * LS2D_PRELOAD_READY, and false is returned.
+ */
+bool ls2d_engine_set_active_scene(Ls2DEngine *self, Ls2DScene *scene);
+
+/**
+ * Load a scene on a worker thread while the active scene keeps running.
+ * The loader (if any) populates the scene, then all of its images are
+ * decoded, and finally textures are uploaded by the engine within a small
+ * per-frame budget. Only one preload may run at a time.
+ */
+bool ls2d_engine_preload_scene(Ls2DEngine *self, Ls2DScene *scene,
+                               ls2d_engine_preload_func loader, void *userdata);
+
+/**
+ * Return the state of the current preload, and optionally the overall
+ * progress between 0.0 and 1.0
+ */
+Ls2DPreloadState ls2d_engine_get_preload_state(Ls2DEngine *self, double *progress);
+
 /**
  * Return the global input manager
  */
@@ -31,6 +31,7 @@ static void ls2d_basic_entity_update(Ls2DEntity *entity, Ls2DTextureCache *cache
                                      Ls2DFrameInfo *frame);
 static void ls2d_basic_entity_add_component(Ls2DEntity *entity, Ls2DComponent *component);
 static Ls2DComponent *ls2d_basic_entity_get_component(Ls2DEntity *entity, int component_id);
+static bool ls2d_basic_entity_remove_component(Ls2DEntity *entity, int component_id);
 
 struct Ls2DBasicEntity {
         Ls2DEntity parent;
@@ -40,6 +41,9 @@ struct Ls2DBasicEntity {
 
         /* components storage */
         LsPtrArray *components;
+
+        /* Direct lookup by component ID, borrowed from components */
+        Ls2DComponent *slots[LS2D_COMP_ID_SLOTS];
 };
 
 /**
@@ -68,6 +72,7 @@ static void ls2d_basic_entity_init(Ls2DBasicEntity *self)
         self->parent.update = ls2d_basic_entity_update;
         self->parent.add_component = ls2d_basic_entity_add_component;
         self->parent.get_component = ls2d_basic_entity_get_component;
+        self->parent.remove_component = ls2d_basic_entity_remove_component;
 }
 
 Ls2DBasicEntity *ls2d_basic_entity_unref(Ls2DBasicEntity *self)
@@ -95,7 +100,17 @@ static void ls2d_basic_entity_add_component(Ls2DEntity *entity, Ls2DComponent *c
         }
 
         ls2d_component_set_parent_entity(component, (Ls2DEntity *)self);
-        ls_array_add(self->components, ls2d_object_ref(component));
+        if (ls_unlikely(!ls_array_add(self->components, ls2d_object_ref(component)))) {
+                ls2d_component_unref(component);
+                return;
+        }
+
+        /* First component with a given ID wins, as lookups always did */
+        if (component->comp_id >= 0 && component->comp_id < LS2D_COMP_ID_SLOTS &&
+            !self->slots[component->comp_id]) {
+                self->slots[component->comp_id] = component;
+                self->parent.comp_mask |= LS2D_COMP_MASK(component->comp_id);
+        }
 }
 
 /**
@@ -126,7 +141,9 @@ static void ls2d_basic_entity_update(Ls2DEntity *entity, Ls2DTextureCache *cache
                 if (!had_init) {
                         ls2d_component_init(comp, cache, frame);
                 }
-                ls2d_component_update(comp, cache, frame);
+                if (!comp->batched) {
+                        ls2d_component_update(comp, cache, frame);
+                }
         }
         if (!had_init) {
                 self->had_init = true;
@@ -137,8 +154,11 @@ static Ls2DComponent *ls2d_basic_entity_get_component(Ls2DEntity *entity, int co
 {
         Ls2DBasicEntity *self = (Ls2DBasicEntity *)entity;
 
-        self = (Ls2DBasicEntity *)entity;
-        /* Easier to have a map in future. */
+        if (component_id >= 0 && component_id < LS2D_COMP_ID_SLOTS) {
+                return self->slots[component_id];
+        }
+
+        /* Unslotted IDs are rare enough to scan for */
         for (uint16_t i = 0; i < self->components->len; i++) {
                 Ls2DComponent *comp = self->components->data[i];
                 if (comp->comp_id == component_id) {
@@ -148,6 +168,47 @@ static Ls2DComponent *ls2d_basic_entity_get_component(Ls2DEntity *entity, int co
         return NULL;
 }
 
+static bool ls2d_basic_entity_remove_component(Ls2DEntity *entity, int component_id)
+{
+        Ls2DBasicEntity *self = (Ls2DBasicEntity *)entity;
+        Ls2DComponent *removed = NULL;
+        bool slotted = component_id >= 0 && component_id < LS2D_COMP_ID_SLOTS;
+
+        for (uint16_t i = 0; i < self->components->len; i++) {
+                Ls2DComponent *comp = self->components->data[i];
+                if (!removed) {
+                        if (comp->comp_id == component_id) {
+                                removed = comp;
+                        }
+                        continue;
+                }
+                /* Shuffle the rest down to keep update order */
+                self->components->data[i - 1] = comp;
+        }
+        if (!removed) {
+                return false;
+        }
+        self->components->len--;
+
+        /* Promote the next component with the same ID, if any */
+        if (slotted && self->slots[component_id] == removed) {
+                self->slots[component_id] = NULL;
+                self->parent.comp_mask &= ~LS2D_COMP_MASK(component_id);
+                for (uint16_t i = 0; i < self->components->len; i++) {
+                        Ls2DComponent *comp = self->components->data[i];
+                        if (comp->comp_id == component_id) {
+                                self->slots[component_id] = comp;
+                                self->parent.comp_mask |= LS2D_COMP_MASK(component_id);
+                                break;
+                        }
+                }
+        }
+
+        ls2d_component_set_parent_entity(removed, NULL);
+        ls2d_component_unref(removed);
+        return true;
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
@@ -24,7 +24,6 @@
 #include "ls2d.h"
 #include "tilemap-private.h"
 
-static void ls2d_image_destroy(Ls2DImage *self);
 static void ls2d_image_init(Ls2DImage *self);
 static void ls2d_image_draw(Ls2DEntity *entity, Ls2DTextureCache *cache, Ls2DFrameInfo *frame);
 static void ls2d_image_update(Ls2DEntity *entity, Ls2DTextureCache *cache, Ls2DFrameInfo *frame);
@@ -40,7 +39,6 @@ struct Ls2DImage {
 Ls2DObjectTable image_vtable = {
         .obj_name = "Ls2DImage",
         .init = (ls2d_object_vfunc_init)ls2d_image_init,
-        .destroy = (ls2d_object_vfunc_destroy)ls2d_image_destroy,
 };
 
 Ls2DEntity *ls2d_image_new(Ls2DTextureHandle handle)
@@ -64,11 +62,6 @@ Ls2DImage *ls2d_image_unref(Ls2DImage *self)
         return ls2d_object_unref(self);
 }
 
-static void ls2d_image_destroy(Ls2DImage *self)
-{
-        free(self);
-}
-
 static void ls2d_image_draw(Ls2DEntity *entity, Ls2DTextureCache *cache, Ls2DFrameInfo *frame)
 {
         Ls2DImage *self = (Ls2DImage *)entity;
@@ -116,7 +109,7 @@ static void ls2d_image_draw(Ls2DEntity *entity, Ls2DTextureCache *cache, Ls2DFra
         source.x = new_x;
         source.y = new_y;
 
-        SDL_RenderCopy(frame->renderer, node->texture, &source, &draw);
+        ls2d_render_copy(frame, node, &source, &draw, 0, SDL_FLIP_NONE);
 }
 
 static void ls2d_image_update(Ls2DEntity *entity, Ls2DTextureCache *cache, Ls2DFrameInfo *frame)
@@ -40,6 +40,7 @@ bool ls2d_tilemap_load_tmx(Ls2DTileMap *self, Ls2DTextureCache *cache, const cha
         bool ret = false;
         int r = 0;
         Ls2DTileMapTMX parser = { 0 };
+        LS2D_PROFILE_FUNC();
         parser.cache = cache;
 
         fd = open(filename, O_RDONLY);
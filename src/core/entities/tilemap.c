@@ -78,8 +78,7 @@ Ls2DEntity *ls2d_tilemap_new_from_tmx(Ls2DTextureCache *cache, const char *filen
         }
 
         if (!ls2d_tilemap_load_tmx(self, cache, filename)) {
-                ls2d_tilemap_destroy(self);
-                free(self);
+                ls2d_tilemap_unref(self);
                 return NULL;
         }
 
@@ -268,13 +267,7 @@ static void ls2d_tilemap_draw(Ls2DEntity *entity, Ls2DTextureCache *cache, Ls2DF
                                         }
                                 }
 
-                                SDL_RenderCopyEx(frame->renderer,
-                                                 node->texture,
-                                                 node->subregion ? &node->area : NULL,
-                                                 &area,
-                                                 0,
-                                                 NULL,
-                                                 0);
+                                ls2d_render_copy(frame, node, NULL, &area, 0, SDL_FLIP_NONE);
                         draw_next:
                                 x_draw += self->tile_size;
                         }
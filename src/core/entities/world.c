@@ -0,0 +1,650 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ls2d.h"
+
+/**
+ * Rows per chunk. All chunks of an archetype are kept full except the last
+ */
+#define LS2D_WORLD_CHUNK_SIZE 512
+
+#define LS2D_WORLD_ALIGN 16
+#define LS2D_WORLD_INDEX_BITS 22
+#define LS2D_WORLD_INDEX_MASK ((1u << LS2D_WORLD_INDEX_BITS) - 1)
+#define LS2D_WORLD_GENERATION_MASK ((1u << (32 - LS2D_WORLD_INDEX_BITS)) - 1)
+#define LS2D_WORLD_NO_RECORD UINT32_MAX
+
+static const size_t component_sizes[LS2D_WORLD_N_COMPONENTS] = {
+        sizeof(struct Ls2DWorldPosition),
+        sizeof(struct Ls2DWorldSprite),
+        sizeof(struct Ls2DWorldAnimation),
+};
+
+/**
+ * A chunk is a single allocation: this header, the entity handles, then
+ * one packed column for each component in the archetype.
+ */
+typedef struct Ls2DWorldChunk {
+        uint32_t count;
+        Ls2DWorldEntity *entities;
+        unsigned char *columns[LS2D_WORLD_N_COMPONENTS];
+} Ls2DWorldChunk;
+
+/**
+ * Table for all entities sharing one component mask
+ */
+typedef struct Ls2DWorldArchetype {
+        uint32_t mask;
+        size_t offsets[LS2D_WORLD_N_COMPONENTS];
+        size_t chunk_size;
+        Ls2DWorldChunk **chunks;
+        uint32_t n_chunks;
+        uint32_t size;
+} Ls2DWorldArchetype;
+
+/**
+ * Where an entity lives. Free records are chained through next_free.
+ */
+typedef struct Ls2DWorldRecord {
+        Ls2DWorldArchetype *archetype;
+        uint32_t chunk;
+        uint32_t row;
+        uint32_t generation;
+        uint32_t next_free;
+} Ls2DWorldRecord;
+
+typedef struct Ls2DWorldSystem {
+        uint32_t mask;
+        ls2d_world_system_func func;
+        void *userdata;
+} Ls2DWorldSystem;
+
+struct Ls2DWorld {
+        Ls2DEntity parent;
+        LsPtrArray *archetypes;
+        LsArray *systems;
+        Ls2DWorldRecord *records;
+        uint32_t n_records;
+        uint32_t size;
+        uint32_t free_record;
+        uint32_t n_entities;
+};
+
+static void ls2d_world_init(Ls2DWorld *self);
+static void ls2d_world_destroy(Ls2DWorld *self);
+static void ls2d_world_draw(Ls2DEntity *entity, Ls2DTextureCache *cache, Ls2DFrameInfo *frame);
+static void ls2d_world_update(Ls2DEntity *entity, Ls2DTextureCache *cache, Ls2DFrameInfo *frame);
+
+/**
+ * We don't yet do anything fancy.
+ */
+Ls2DObjectTable world_vtable = {
+        .obj_name = "Ls2DWorld",
+        .init = (ls2d_object_vfunc_init)ls2d_world_init,
+        .destroy = (ls2d_object_vfunc_destroy)ls2d_world_destroy,
+};
+
+Ls2DEntity *ls2d_world_new()
+{
+        Ls2DWorld *self = LS2D_NEW(Ls2DWorld, world_vtable);
+        if (ls_unlikely(!self)) {
+                return NULL;
+        }
+        if (ls_unlikely(!self->archetypes) || ls_unlikely(!self->systems)) {
+                return (Ls2DEntity *)ls2d_world_unref(self);
+        }
+        return (Ls2DEntity *)self;
+}
+
+static void ls2d_world_init(Ls2DWorld *self)
+{
+        self->archetypes = ls_ptr_array_new_size(8);
+        self->systems = ls_array_new_size(sizeof(struct Ls2DWorldSystem), 4);
+        self->free_record = LS2D_WORLD_NO_RECORD;
+        self->parent.draw = ls2d_world_draw;
+        self->parent.update = ls2d_world_update;
+}
+
+Ls2DWorld *ls2d_world_unref(Ls2DWorld *self)
+{
+        return ls2d_object_unref(self);
+}
+
+static inline void *ls2d_world_chunk_get(Ls2DWorldChunk *chunk, Ls2DWorldComponentType type,
+                                         uint32_t row)
+{
+        return chunk->columns[type] + row * component_sizes[type];
+}
+
+/**
+ * Drop anything referenced from the row's component data
+ */
+static void ls2d_world_chunk_release(Ls2DWorldChunk *chunk, uint32_t row)
+{
+        Ls2DWorldAnimation *anim = NULL;
+
+        if (chunk->columns[LS2D_WORLD_ANIMATION] == NULL) {
+                return;
+        }
+        anim = ls2d_world_chunk_get(chunk, LS2D_WORLD_ANIMATION, row);
+        if (anim->animation != NULL) {
+                anim->animation = ls2d_animation_unref(anim->animation);
+        }
+}
+
+static void ls2d_world_archetype_free(Ls2DWorldArchetype *archetype)
+{
+        for (uint32_t i = 0; i < archetype->n_chunks; i++) {
+                Ls2DWorldChunk *chunk = archetype->chunks[i];
+                for (uint32_t row = 0; row < chunk->count; row++) {
+                        ls2d_world_chunk_release(chunk, row);
+                }
+                free(chunk);
+        }
+        free(archetype->chunks);
+        free(archetype);
+}
+
+static void ls2d_world_destroy(Ls2DWorld *self)
+{
+        if (ls_likely(self->archetypes != NULL)) {
+                ls_array_free(self->archetypes, ls2d_world_archetype_free);
+        }
+        if (ls_likely(self->systems != NULL)) {
+                ls_array_free(self->systems, NULL);
+        }
+        free(self->records);
+}
+
+static inline size_t ls2d_world_align(size_t size)
+{
+        return (size + LS2D_WORLD_ALIGN - 1) & ~(size_t)(LS2D_WORLD_ALIGN - 1);
+}
+
+static Ls2DWorldArchetype *ls2d_world_get_archetype(Ls2DWorld *self, uint32_t mask)
+{
+        Ls2DWorldArchetype *archetype = NULL;
+        size_t offset = 0;
+
+        for (uint32_t i = 0; i < self->archetypes->len; i++) {
+                archetype = self->archetypes->data[i];
+                if (archetype->mask == mask) {
+                        return archetype;
+                }
+        }
+
+        archetype = calloc(1, sizeof(struct Ls2DWorldArchetype));
+        if (ls_unlikely(!archetype)) {
+                return NULL;
+        }
+        archetype->mask = mask;
+
+        /* Work out the chunk layout once */
+        offset = ls2d_world_align(sizeof(struct Ls2DWorldChunk));
+        offset += ls2d_world_align(LS2D_WORLD_CHUNK_SIZE * sizeof(Ls2DWorldEntity));
+        for (int t = 0; t < LS2D_WORLD_N_COMPONENTS; t++) {
+                if (!(mask & LS2D_WORLD_MASK(t))) {
+                        continue;
+                }
+                archetype->offsets[t] = offset;
+                offset += ls2d_world_align(LS2D_WORLD_CHUNK_SIZE * component_sizes[t]);
+        }
+        archetype->chunk_size = offset;
+
+        if (ls_unlikely(!ls_array_add(self->archetypes, archetype))) {
+                free(archetype);
+                return NULL;
+        }
+        return archetype;
+}
+
+static Ls2DWorldChunk *ls2d_world_archetype_add_chunk(Ls2DWorldArchetype *archetype)
+{
+        Ls2DWorldChunk *chunk = NULL;
+        Ls2DWorldChunk **chunks = NULL;
+        unsigned char *base = NULL;
+
+        if (archetype->n_chunks >= archetype->size) {
+                uint32_t size = archetype->size > 0 ? archetype->size * 2 : 4;
+                chunks = realloc(archetype->chunks, size * sizeof(Ls2DWorldChunk *));
+                if (ls_unlikely(!chunks)) {
+                        return NULL;
+                }
+                archetype->chunks = chunks;
+                archetype->size = size;
+        }
+
+        base = malloc(archetype->chunk_size);
+        if (ls_unlikely(!base)) {
+                return NULL;
+        }
+        chunk = (Ls2DWorldChunk *)base;
+        chunk->count = 0;
+        chunk->entities =
+            (Ls2DWorldEntity *)(base + ls2d_world_align(sizeof(struct Ls2DWorldChunk)));
+        for (int t = 0; t < LS2D_WORLD_N_COMPONENTS; t++) {
+                chunk->columns[t] =
+                    (archetype->mask & LS2D_WORLD_MASK(t)) ? base + archetype->offsets[t] : NULL;
+        }
+
+        archetype->chunks[archetype->n_chunks++] = chunk;
+        return chunk;
+}
+
+/**
+ * Claim a zeroed row at the end of the archetype
+ */
+static bool ls2d_world_archetype_push(Ls2DWorldArchetype *archetype, Ls2DWorldEntity entity,
+                                      uint32_t *chunk_index, uint32_t *row)
+{
+        Ls2DWorldChunk *chunk = NULL;
+
+        if (archetype->n_chunks > 0) {
+                chunk = archetype->chunks[archetype->n_chunks - 1];
+        }
+        if (!chunk || chunk->count >= LS2D_WORLD_CHUNK_SIZE) {
+                chunk = ls2d_world_archetype_add_chunk(archetype);
+                if (ls_unlikely(!chunk)) {
+                        return false;
+                }
+        }
+
+        *chunk_index = archetype->n_chunks - 1;
+        *row = chunk->count++;
+        chunk->entities[*row] = entity;
+        for (int t = 0; t < LS2D_WORLD_N_COMPONENTS; t++) {
+                if (chunk->columns[t] != NULL) {
+                        memset(ls2d_world_chunk_get(chunk, t, *row), 0, component_sizes[t]);
+                }
+        }
+        return true;
+}
+
+static inline Ls2DWorldRecord *ls2d_world_lookup(Ls2DWorld *self, Ls2DWorldEntity entity)
+{
+        uint32_t index = entity & LS2D_WORLD_INDEX_MASK;
+        Ls2DWorldRecord *record = NULL;
+
+        if (ls_unlikely(!self) || ls_unlikely(index >= self->n_records)) {
+                return NULL;
+        }
+        record = &self->records[index];
+        if (!record->archetype || record->generation != entity >> LS2D_WORLD_INDEX_BITS) {
+                return NULL;
+        }
+        return record;
+}
+
+/**
+ * Remove a row by moving the archetype's last row into its place, so the
+ * chunks stay densely packed. Component data is not released here.
+ */
+static void ls2d_world_archetype_remove(Ls2DWorld *self, Ls2DWorldArchetype *archetype,
+                                        uint32_t chunk_index, uint32_t row)
+{
+        Ls2DWorldChunk *chunk = archetype->chunks[chunk_index];
+        Ls2DWorldChunk *last = archetype->chunks[archetype->n_chunks - 1];
+        uint32_t last_row = last->count - 1;
+
+        if (chunk != last || row != last_row) {
+                Ls2DWorldEntity moved = last->entities[last_row];
+                Ls2DWorldRecord *record = &self->records[moved & LS2D_WORLD_INDEX_MASK];
+
+                chunk->entities[row] = moved;
+                for (int t = 0; t < LS2D_WORLD_N_COMPONENTS; t++) {
+                        if (chunk->columns[t] != NULL) {
+                                memcpy(ls2d_world_chunk_get(chunk, t, row),
+                                       ls2d_world_chunk_get(last, t, last_row),
+                                       component_sizes[t]);
+                        }
+                }
+                record->chunk = chunk_index;
+                record->row = row;
+        }
+
+        last->count--;
+        if (last->count == 0 && archetype->n_chunks > 1) {
+                free(last);
+                archetype->n_chunks--;
+        }
+}
+
+Ls2DWorldEntity ls2d_world_spawn(Ls2DWorld *self, uint32_t mask)
+{
+        Ls2DWorldArchetype *archetype = NULL;
+        Ls2DWorldRecord *record = NULL;
+        Ls2DWorldEntity entity;
+        uint32_t index;
+
+        if (ls_unlikely(!self)) {
+                return LS2D_WORLD_ENTITY_NONE;
+        }
+        archetype = ls2d_world_get_archetype(self, mask);
+        if (ls_unlikely(!archetype)) {
+                return LS2D_WORLD_ENTITY_NONE;
+        }
+
+        /* Reuse a free record, else grow */
+        if (self->free_record != LS2D_WORLD_NO_RECORD) {
+                index = self->free_record;
+        } else {
+                if (ls_unlikely(self->n_records > LS2D_WORLD_INDEX_MASK)) {
+                        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "World entity limit reached");
+                        return LS2D_WORLD_ENTITY_NONE;
+                }
+                if (self->n_records >= self->size) {
+                        uint32_t size = self->size > 0 ? self->size * 2 : 64;
+                        Ls2DWorldRecord *records =
+                            realloc(self->records, size * sizeof(struct Ls2DWorldRecord));
+                        if (ls_unlikely(!records)) {
+                                return LS2D_WORLD_ENTITY_NONE;
+                        }
+                        self->records = records;
+                        self->size = size;
+                }
+                index = self->n_records;
+                self->records[index] = (Ls2DWorldRecord){ .generation = 1 };
+        }
+
+        record = &self->records[index];
+        entity = (record->generation << LS2D_WORLD_INDEX_BITS) | index;
+        if (!ls2d_world_archetype_push(archetype, entity, &record->chunk, &record->row)) {
+                return LS2D_WORLD_ENTITY_NONE;
+        }
+
+        if (index == self->free_record) {
+                self->free_record = record->next_free;
+        } else {
+                self->n_records++;
+        }
+        record->archetype = archetype;
+        self->n_entities++;
+        return entity;
+}
+
+void ls2d_world_despawn(Ls2DWorld *self, Ls2DWorldEntity entity)
+{
+        Ls2DWorldRecord *record = ls2d_world_lookup(self, entity);
+
+        if (ls_unlikely(!record)) {
+                return;
+        }
+
+        ls2d_world_chunk_release(record->archetype->chunks[record->chunk], record->row);
+        ls2d_world_archetype_remove(self, record->archetype, record->chunk, record->row);
+
+        /* Invalidate outstanding handles, never handing out generation 0 */
+        record->archetype = NULL;
+        record->generation = (record->generation + 1) & LS2D_WORLD_GENERATION_MASK;
+        if (record->generation == 0) {
+                record->generation = 1;
+        }
+        record->next_free = self->free_record;
+        self->free_record = entity & LS2D_WORLD_INDEX_MASK;
+        self->n_entities--;
+}
+
+bool ls2d_world_is_alive(Ls2DWorld *self, Ls2DWorldEntity entity)
+{
+        return ls2d_world_lookup(self, entity) != NULL;
+}
+
+bool ls2d_world_set_mask(Ls2DWorld *self, Ls2DWorldEntity entity, uint32_t mask)
+{
+        Ls2DWorldRecord *record = ls2d_world_lookup(self, entity);
+        Ls2DWorldArchetype *archetype = NULL;
+        Ls2DWorldChunk *from = NULL;
+        Ls2DWorldChunk *to = NULL;
+        uint32_t chunk_index, row;
+
+        if (ls_unlikely(!record)) {
+                return false;
+        }
+        if (record->archetype->mask == mask) {
+                return true;
+        }
+
+        archetype = ls2d_world_get_archetype(self, mask);
+        if (ls_unlikely(!archetype)) {
+                return false;
+        }
+        if (!ls2d_world_archetype_push(archetype, entity, &chunk_index, &row)) {
+                return false;
+        }
+
+        /* Carry over whatever the two archetypes have in common */
+        from = record->archetype->chunks[record->chunk];
+        to = archetype->chunks[chunk_index];
+        for (int t = 0; t < LS2D_WORLD_N_COMPONENTS; t++) {
+                if (from->columns[t] != NULL && to->columns[t] != NULL) {
+                        memcpy(ls2d_world_chunk_get(to, t, row),
+                               ls2d_world_chunk_get(from, t, record->row),
+                               component_sizes[t]);
+                }
+        }
+        if (!(mask & LS2D_WORLD_MASK(LS2D_WORLD_ANIMATION))) {
+                ls2d_world_chunk_release(from, record->row);
+        }
+
+        ls2d_world_archetype_remove(self, record->archetype, record->chunk, record->row);
+        record->archetype = archetype;
+        record->chunk = chunk_index;
+        record->row = row;
+        return true;
+}
+
+uint32_t ls2d_world_get_mask(Ls2DWorld *self, Ls2DWorldEntity entity)
+{
+        Ls2DWorldRecord *record = ls2d_world_lookup(self, entity);
+
+        if (ls_unlikely(!record)) {
+                return 0;
+        }
+        return record->archetype->mask;
+}
+
+void *ls2d_world_get_component(Ls2DWorld *self, Ls2DWorldEntity entity,
+                               Ls2DWorldComponentType type)
+{
+        Ls2DWorldRecord *record = ls2d_world_lookup(self, entity);
+        Ls2DWorldChunk *chunk = NULL;
+
+        if (ls_unlikely(!record) || ls_unlikely(type >= LS2D_WORLD_N_COMPONENTS)) {
+                return NULL;
+        }
+        chunk = record->archetype->chunks[record->chunk];
+        if (chunk->columns[type] == NULL) {
+                return NULL;
+        }
+        return ls2d_world_chunk_get(chunk, type, record->row);
+}
+
+bool ls2d_world_set_animation(Ls2DWorld *self, Ls2DWorldEntity entity, Ls2DAnimation *animation)
+{
+        Ls2DWorldAnimation *anim = NULL;
+
+        anim = ls2d_world_get_component(self, entity, LS2D_WORLD_ANIMATION);
+        if (ls_unlikely(!anim)) {
+                return false;
+        }
+        if (animation != NULL) {
+                ls2d_object_ref(animation);
+        }
+        if (anim->animation != NULL) {
+                ls2d_animation_unref(anim->animation);
+        }
+        anim->animation = animation;
+        return true;
+}
+
+uint32_t ls2d_world_get_count(Ls2DWorld *self)
+{
+        if (ls_unlikely(!self)) {
+                return 0;
+        }
+        return self->n_entities;
+}
+
+void ls2d_world_each(Ls2DWorld *self, uint32_t mask, ls2d_world_system_func system,
+                     Ls2DFrameInfo *frame, void *userdata)
+{
+        if (ls_unlikely(!self) || ls_unlikely(!system)) {
+                return;
+        }
+
+        for (uint32_t i = 0; i < self->archetypes->len; i++) {
+                Ls2DWorldArchetype *archetype = self->archetypes->data[i];
+
+                if ((archetype->mask & mask) != mask) {
+                        continue;
+                }
+                for (uint32_t c = 0; c < archetype->n_chunks; c++) {
+                        Ls2DWorldChunk *chunk = archetype->chunks[c];
+                        Ls2DWorldView view = {
+                                .count = chunk->count,
+                                .entities = chunk->entities,
+                                .positions = (void *)chunk->columns[LS2D_WORLD_POSITION],
+                                .sprites = (void *)chunk->columns[LS2D_WORLD_SPRITE],
+                                .animations = (void *)chunk->columns[LS2D_WORLD_ANIMATION],
+                        };
+                        if (view.count > 0) {
+                                system(&view, frame, userdata);
+                        }
+                }
+        }
+}
+
+bool ls2d_world_add_system(Ls2DWorld *self, uint32_t mask, ls2d_world_system_func system,
+                           void *userdata)
+{
+        Ls2DWorldSystem *entry = NULL;
+
+        if (ls_unlikely(!self) || ls_unlikely(!system)) {
+                return false;
+        }
+        if (ls_unlikely(!ls_array_add(self->systems, NULL))) {
+                return false;
+        }
+        entry = &((Ls2DWorldSystem *)self->systems->data)[self->systems->len - 1];
+        entry->mask = mask;
+        entry->func = system;
+        entry->userdata = userdata;
+        return true;
+}
+
+/**
+ * Step animations, feeding the current frame to the sprite if present
+ */
+static void ls2d_world_animation_system(Ls2DWorldView *view, Ls2DFrameInfo *frame,
+                                        __ls_unused__ void *userdata)
+{
+        for (uint32_t i = 0; i < view->count; i++) {
+                Ls2DAnimation *animation = view->animations[i].animation;
+                if (!animation) {
+                        continue;
+                }
+                ls2d_animation_update(animation, frame);
+                if (view->sprites) {
+                        view->sprites[i].handle = ls2d_animation_get_texture(animation);
+                }
+        }
+}
+
+/**
+ * Draw every positioned sprite that falls within the camera view
+ */
+static void ls2d_world_sprite_system(Ls2DWorldView *view, Ls2DFrameInfo *frame, void *userdata)
+{
+        Ls2DTextureCache *cache = userdata;
+        SDL_Rect camera = { 0 };
+
+        if (!ls2d_camera_get_view(frame->camera, &camera)) {
+                return;
+        }
+
+        for (uint32_t i = 0; i < view->count; i++) {
+                const Ls2DWorldSprite *sprite = &view->sprites[i];
+                const Ls2DTextureNode *node = NULL;
+                SDL_Rect dst;
+
+                node = ls2d_texture_cache_lookup(cache, frame, sprite->handle);
+                if (ls_unlikely(!node)) {
+                        continue;
+                }
+                dst.x = view->positions[i].pos.x - camera.x;
+                dst.y = view->positions[i].pos.y - camera.y;
+                dst.w = node->area.w;
+                dst.h = node->area.h;
+                if (dst.x + dst.w < 0 || dst.y + dst.h < 0 || dst.x > camera.w ||
+                    dst.y > camera.h) {
+                        continue;
+                }
+                ls2d_render_copy(frame, node, NULL, &dst, sprite->rotation, sprite->flip);
+        }
+}
+
+static void ls2d_world_update(Ls2DEntity *entity, __ls_unused__ Ls2DTextureCache *cache,
+                              Ls2DFrameInfo *frame)
+{
+        Ls2DWorld *self = (Ls2DWorld *)entity;
+
+        LS2D_PROFILE_FUNC();
+
+        ls2d_world_each(self,
+                        LS2D_WORLD_MASK(LS2D_WORLD_ANIMATION),
+                        ls2d_world_animation_system,
+                        frame,
+                        NULL);
+
+        for (uint32_t i = 0; i < self->systems->len; i++) {
+                Ls2DWorldSystem *system = &((Ls2DWorldSystem *)self->systems->data)[i];
+                ls2d_world_each(self, system->mask, system->func, frame, system->userdata);
+        }
+}
+
+static void ls2d_world_draw(Ls2DEntity *entity, Ls2DTextureCache *cache, Ls2DFrameInfo *frame)
+{
+        LS2D_PROFILE_FUNC();
+
+        ls2d_world_each((Ls2DWorld *)entity,
+                        LS2D_WORLD_MASK(LS2D_WORLD_POSITION) | LS2D_WORLD_MASK(LS2D_WORLD_SPRITE),
+                        ls2d_world_sprite_system,
+                        frame,
+                        cache);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
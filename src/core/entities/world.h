@@ -0,0 +1,185 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include "ls2d.h"
+
+/**
+ * Ls2DWorld is an entity holding many lightweight entities in archetype
+ * storage. Entities with the same set of components share a table, split
+ * into fixed size chunks holding one packed array per component type, so
+ * systems walk plain arrays rather than chasing component pointers.
+ *
+ * Add the world to a scene like any other entity: updating it runs the
+ * animation system followed by any registered systems, and drawing it
+ * runs the sprite system.
+ */
+
+/**
+ * Handle to an entity within a world. Handles are generational, so a
+ * stale handle to a despawned entity is simply rejected.
+ */
+typedef uint32_t Ls2DWorldEntity;
+
+#define LS2D_WORLD_ENTITY_NONE 0
+
+/**
+ * Component types supported by world storage
+ */
+typedef enum Ls2DWorldComponentType {
+        LS2D_WORLD_POSITION = 0,
+        LS2D_WORLD_SPRITE,
+        LS2D_WORLD_ANIMATION,
+        LS2D_WORLD_N_COMPONENTS,
+} Ls2DWorldComponentType;
+
+/**
+ * Bit for a component type within an archetype mask
+ */
+#define LS2D_WORLD_MASK(t) (1u << (t))
+
+/**
+ * Position data, equivalent to Ls2DPositionComponent
+ */
+typedef struct Ls2DWorldPosition {
+        SDL_Point pos;
+        int pos_z;
+} Ls2DWorldPosition;
+
+/**
+ * Sprite data, equivalent to Ls2DSpriteComponent
+ */
+typedef struct Ls2DWorldSprite {
+        Ls2DTextureHandle handle;
+        SDL_RendererFlip flip;
+        double rotation;
+} Ls2DWorldSprite;
+
+/**
+ * Animation data. The world holds a reference on the animation, and the
+ * animation system writes its current texture into the entity's sprite.
+ */
+typedef struct Ls2DWorldAnimation {
+        Ls2DAnimation *animation;
+} Ls2DWorldAnimation;
+
+/**
+ * One chunk's worth of entities matching a query. Columns for components
+ * outside the archetype are NULL, otherwise index i of every column
+ * belongs to entities[i].
+ */
+typedef struct Ls2DWorldView {
+        uint32_t count;
+        const Ls2DWorldEntity *entities;
+        Ls2DWorldPosition *positions;
+        Ls2DWorldSprite *sprites;
+        Ls2DWorldAnimation *animations;
+} Ls2DWorldView;
+
+typedef void (*ls2d_world_system_func)(Ls2DWorldView *view, Ls2DFrameInfo *frame,
+                                       void *userdata);
+
+/**
+ * Construct a new, empty Ls2DWorld
+ */
+Ls2DEntity *ls2d_world_new(void);
+
+/**
+ * Unref a previously allocated Ls2DWorld
+ */
+Ls2DWorld *ls2d_world_unref(Ls2DWorld *self);
+
+/**
+ * Create an entity with the given component mask. Component data starts
+ * zeroed. Returns LS2D_WORLD_ENTITY_NONE on failure.
+ */
+Ls2DWorldEntity ls2d_world_spawn(Ls2DWorld *self, uint32_t mask);
+
+/**
+ * Destroy an entity, releasing anything its components hold
+ */
+void ls2d_world_despawn(Ls2DWorld *self, Ls2DWorldEntity entity);
+
+/**
+ * Determine whether the handle refers to a live entity
+ */
+bool ls2d_world_is_alive(Ls2DWorld *self, Ls2DWorldEntity entity);
+
+/**
+ * Move the entity to the archetype for the new mask. Data for components
+ * in both masks is kept, new components start zeroed.
+ */
+bool ls2d_world_set_mask(Ls2DWorld *self, Ls2DWorldEntity entity, uint32_t mask);
+
+/**
+ * Return the component mask of the entity, or 0 if it isn't alive
+ */
+uint32_t ls2d_world_get_mask(Ls2DWorld *self, Ls2DWorldEntity entity);
+
+/**
+ * Get a pointer to the entity's data for the given component type, or NULL
+ * if the entity doesn't have it. The pointer is only valid until the next
+ * spawn, despawn or mask change.
+ */
+void *ls2d_world_get_component(Ls2DWorld *self, Ls2DWorldEntity entity,
+                               Ls2DWorldComponentType type);
+
+/**
+ * Set the entity's animation, taking a new reference to it
+ */
+bool ls2d_world_set_animation(Ls2DWorld *self, Ls2DWorldEntity entity, Ls2DAnimation *animation);
+
+/**
+ * Return the number of live entities
+ */
+uint32_t ls2d_world_get_count(Ls2DWorld *self);
+
+/**
+ * Call system once per chunk of every archetype containing all of mask
+ */
+void ls2d_world_each(Ls2DWorld *self, uint32_t mask, ls2d_world_system_func system,
+                     Ls2DFrameInfo *frame, void *userdata);
+
+/**
+ * Register a system to be run over mask on every world update
+ */
+bool ls2d_world_add_system(Ls2DWorld *self, uint32_t mask, ls2d_world_system_func system,
+                           void *userdata);
+
+DEF_AUTOFREE(Ls2DWorld, ls2d_world_unref)
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -28,6 +28,7 @@ void ls2d_entity_draw(Ls2DEntity *self, Ls2DTextureCache *cache, Ls2DFrameInfo *
         if (ls_unlikely(!self) || ls_unlikely(!self->draw)) {
                 return;
         }
+        LS2D_PROFILE_OBJECT(self);
         self->draw(self, cache, info);
 }
 
@@ -36,6 +37,7 @@ void ls2d_entity_update(Ls2DEntity *self, Ls2DTextureCache *cache, Ls2DFrameInfo
         if (ls_unlikely(!self) || ls_unlikely(!self->update)) {
                 return;
         }
+        LS2D_PROFILE_OBJECT(self);
         self->update(self, cache, info);
 }
 
@@ -47,14 +49,59 @@ void ls2d_entity_add_component(Ls2DEntity *self, Ls2DComponent *component)
         self->add_component(self, component);
 }
 
+static inline bool ls2d_entity_is_slotted(int component_id)
+{
+        return component_id >= 0 && component_id < LS2D_COMP_ID_SLOTS;
+}
+
 Ls2DComponent *ls2d_entity_get_component(Ls2DEntity *self, int component_id)
 {
         if (ls_unlikely(!self) || ls_unlikely(!self->get_component)) {
                 return NULL;
         }
+        /* Don't bother asking when the signature says it isn't there */
+        if (ls2d_entity_is_slotted(component_id) &&
+            !(self->comp_mask & LS2D_COMP_MASK(component_id))) {
+                return NULL;
+        }
         return self->get_component(self, component_id);
 }
 
+bool ls2d_entity_remove_component(Ls2DEntity *self, int component_id)
+{
+        if (ls_unlikely(!self) || ls_unlikely(!self->remove_component)) {
+                return false;
+        }
+        return self->remove_component(self, component_id);
+}
+
+bool ls2d_entity_has_component(Ls2DEntity *self, int component_id)
+{
+        if (ls_unlikely(!self)) {
+                return false;
+        }
+        if (ls2d_entity_is_slotted(component_id)) {
+                return (self->comp_mask & LS2D_COMP_MASK(component_id)) != 0;
+        }
+        return ls2d_entity_get_component(self, component_id) != NULL;
+}
+
+uint32_t ls2d_entity_get_signature(Ls2DEntity *self)
+{
+        if (ls_unlikely(!self)) {
+                return 0;
+        }
+        return self->comp_mask;
+}
+
+Ls2DEntityHandle ls2d_entity_get_handle(Ls2DEntity *self)
+{
+        if (ls_unlikely(!self)) {
+                return LS2D_ENTITY_HANDLE_NONE;
+        }
+        return self->handle;
+}
+
 Ls2DEntity *ls2d_entity_unref(Ls2DEntity *self)
 {
         return ls2d_object_unref(self);
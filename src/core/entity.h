@@ -31,10 +31,19 @@
 struct Ls2DEntity {
         Ls2DObject object;
 
+        /* Signature: LS2D_COMP_MASK bit of each slotted component present.
+         * Subtypes implementing add_component must keep this up to date. */
+        uint32_t comp_mask;
+
+        /* Handle within the scene we were last added to */
+        Ls2DEntityHandle handle;
+        Ls2DScene *scene;
+
         /* Draw callback that all components should implemented */
         void (*draw)(struct Ls2DEntity *, Ls2DTextureCache *, Ls2DFrameInfo *);
 
-        /* Update callback that all components should implement */
+        /* Update callback that all components should implement. With engine worker
+         * threads, entities update concurrently so must only touch their own state. */
         void (*update)(struct Ls2DEntity *, Ls2DTextureCache *, Ls2DFrameInfo *);
 
         /* Add a component. Must be implemented by subtypes. */
@@ -42,6 +51,9 @@ struct Ls2DEntity {
 
         /* Get a component. Must be implemented by subtypes */
         Ls2DComponent *(*get_component)(struct Ls2DEntity *, int component_id);
+
+        /* Remove a component by ID. Optional for subtypes */
+        bool (*remove_component)(struct Ls2DEntity *, int component_id);
 };
 
 /**
@@ -64,6 +76,29 @@ void ls2d_entity_add_component(Ls2DEntity *self, Ls2DComponent *component);
  */
 Ls2DComponent *ls2d_entity_get_component(Ls2DEntity *self, int component_id);
 
+/**
+ * Remove the first component with the given ID from the entity. While the
+ * entity is in a scene use ls2d_scene_queue_remove_component instead, so
+ * the scene can stop updating the component first.
+ */
+bool ls2d_entity_remove_component(Ls2DEntity *self, int component_id);
+
+/**
+ * Determine whether the entity has a component with the given ID
+ */
+bool ls2d_entity_has_component(Ls2DEntity *self, int component_id);
+
+/**
+ * Return the entity signature, a mask of LS2D_COMP_MASK bits
+ */
+uint32_t ls2d_entity_get_signature(Ls2DEntity *self);
+
+/**
+ * Return the handle assigned by the scene the entity was last added to,
+ * or LS2D_ENTITY_HANDLE_NONE
+ */
+Ls2DEntityHandle ls2d_entity_get_handle(Ls2DEntity *self);
+
 /**
  * Unref a previously allocated Ls2DEntity
  */
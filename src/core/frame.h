@@ -29,34 +29,82 @@
 #include <stdlib.h>
 #include <time.h>
 
+/**
+ * Time within the engine is tracked in nanoseconds, derived from the
+ * SDL performance counter.
+ */
+#define LS2D_NS_PER_SEC 1000000000ULL
+#define LS2D_NS_PER_MS 1000000ULL
+
+/**
+ * When delaying a frame we sleep for the bulk of the wait, and spin out
+ * the final stretch as SDL_Delay is only accurate to a millisecond or so.
+ */
+#define LS2D_FRAME_SPIN_NS (2 * LS2D_NS_PER_MS)
+
 /**
  * The Ls2DFrameInfo object is passed to renderer and update cycles
  * to give them information about the current frame pass.
  */
 struct Ls2DFrameInfo {
-        uint32_t tick_start;     /**<First tick */
-        uint32_t ticks;          /**<Current tick count */
-        uint32_t prev_ticks;     /**<Previous tick count */
-        uint32_t tick_increment; /**<Tick increment from last */
+        uint64_t tick_start;     /**<Performance counter at first tick */
+        uint64_t ticks;          /**<Current tick count (ns) */
+        uint64_t prev_ticks;     /**<Previous tick count (ns) */
+        uint64_t tick_increment; /**<Tick increment from last (ns) */
+        double alpha;            /**<Interpolation between the last two simulation ticks */
         SDL_Renderer *renderer;  /**<Current renderer */
         SDL_Window *window;      /**<Displayed window */
-        Ls2DCamera *camera;      /**<Offset support. We need a sprite batcher. */
-        uint32_t frames[5];
+        Ls2DCamera *camera;      /**<Offset support */
+        Ls2DRenderQueue *queue;  /**<When set, draws are recorded here instead of issued */
+        Ls2DJobPool *jobs;       /**<When set, scene updates are spread over these workers */
+        uint64_t frames[5];
         uint32_t i_frame;
-        uint32_t tick_delay;
+        uint64_t tick_delay;
 };
 
+/**
+ * Convert a performance counter delta into nanoseconds without overflowing
+ * the intermediate multiplication.
+ */
+__attribute__((always_inline)) inline uint64_t ls2d_frame_info_counter_to_ns(uint64_t counter)
+{
+        const uint64_t freq = SDL_GetPerformanceFrequency();
+        return (counter / freq) * LS2D_NS_PER_SEC + ((counter % freq) * LS2D_NS_PER_SEC) / freq;
+}
+
+/**
+ * Return the current time in nanoseconds relative to the first tick
+ */
+__attribute__((always_inline)) inline uint64_t ls2d_frame_info_now(Ls2DFrameInfo *frame)
+{
+        return ls2d_frame_info_counter_to_ns(SDL_GetPerformanceCounter() - frame->tick_start);
+}
+
 __attribute__((always_inline)) inline void ls2d_frame_info_init(Ls2DFrameInfo *frame)
 {
-        frame->tick_start = SDL_GetTicks();
-        frame->prev_ticks = frame->tick_start - 1;
+        frame->tick_start = SDL_GetPerformanceCounter();
+        frame->ticks = 0;
+        frame->prev_ticks = 0;
 }
 
 __attribute__((always_inline)) inline void ls2d_frame_info_tick(Ls2DFrameInfo *frame)
 {
-        frame->ticks = SDL_GetTicks() - frame->tick_start;
+        frame->ticks = ls2d_frame_info_now(frame);
         frame->tick_increment = frame->ticks - frame->prev_ticks;
-        frame->frames[frame->i_frame % 5] = frame->ticks - frame->prev_ticks;
+        frame->frames[frame->i_frame % 5] = frame->tick_increment;
+        frame->i_frame++;
+}
+
+/**
+ * Synthetic tick, advancing the frame clock by a fixed increment rather
+ * than by the real time elapsed. Used for deterministic replays.
+ */
+__attribute__((always_inline)) inline void ls2d_frame_info_advance(Ls2DFrameInfo *frame,
+                                                                   uint64_t increment)
+{
+        frame->ticks = frame->prev_ticks + increment;
+        frame->tick_increment = increment;
+        frame->frames[frame->i_frame % 5] = frame->tick_increment;
         frame->i_frame++;
 }
 
@@ -66,12 +114,25 @@ __attribute__((always_inline)) inline void ls2d_frame_info_stash(Ls2DFrameInfo *
         frame->prev_ticks = frame->ticks;
 }
 
-/*
-__attribute__((always_inline)) inline void ls2d_frame_info_delay(Ls2DFrameInfo *frame, uint32_t
-fps_delay, double fps)
+/**
+ * Wait until frame_time nanoseconds have passed since the start of the
+ * current frame. If we're already late, return immediately.
+ */
+__attribute__((always_inline)) inline void ls2d_frame_info_delay(Ls2DFrameInfo *frame,
+                                                                 uint64_t frame_time)
 {
+        const uint64_t deadline = frame->ticks + frame_time;
+        uint64_t now = ls2d_frame_info_now(frame);
+
+        if (now + LS2D_FRAME_SPIN_NS < deadline) {
+                SDL_Delay((uint32_t)((deadline - now - LS2D_FRAME_SPIN_NS) / LS2D_NS_PER_MS));
+                now = ls2d_frame_info_now(frame);
+        }
+
+        while (now < deadline) {
+                now = ls2d_frame_info_now(frame);
+        }
 }
-*/
 
 __attribute__((always_inline)) inline double ls2d_frame_info_get_fps(Ls2DFrameInfo *frame)
 {
@@ -79,10 +140,13 @@ __attribute__((always_inline)) inline double ls2d_frame_info_get_fps(Ls2DFrameIn
         double fps = 0;
 
         for (unsigned int i = 0; i < total; i++) {
-                fps += frame->frames[i];
+                fps += (double)frame->frames[i];
+        }
+        if (ls_unlikely(fps <= 0.0)) {
+                return 0.0;
         }
         fps /= total;
-        return 1000.0 / fps;
+        return (double)LS2D_NS_PER_SEC / fps;
 }
 
 /*
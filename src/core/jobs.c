@@ -0,0 +1,400 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#include <SDL.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "ls2d.h"
+
+/**
+ * Jobs each thread can have outstanding. Beyond this, the submitting
+ * thread just runs the range itself.
+ */
+#define LS2D_JOB_DEQUE_SIZE 1024
+
+/**
+ * Matches the number of threads the profiler can track
+ */
+#define LS2D_JOB_MAX_THREADS 16
+
+/**
+ * Ranges per thread when picking a grain automatically, so that early
+ * finishers have something left to steal.
+ */
+#define LS2D_JOB_SPLIT 4
+
+typedef struct Ls2DJob {
+        ls2d_job_func func;
+        void *userdata;
+        uint32_t begin;
+        uint32_t end;
+        atomic_uint *pending;
+} Ls2DJob;
+
+/**
+ * The owner pushes and pops at the bottom, thieves take from the top.
+ * Jobs are coarse ranges, so a spinlock per deque is plenty.
+ */
+typedef struct Ls2DJobDeque {
+        atomic_bool locked;
+        uint32_t top;
+        uint32_t bottom;
+        Ls2DJob jobs[LS2D_JOB_DEQUE_SIZE];
+} Ls2DJobDeque;
+
+typedef struct Ls2DJobWorker {
+        Ls2DJobPool *pool;
+        uint32_t index;
+        SDL_Thread *thread;
+} Ls2DJobWorker;
+
+struct Ls2DJobPool {
+        uint32_t n_threads; /**<Deque 0 belongs to whichever thread submits */
+        Ls2DJobDeque *deques;
+        Ls2DJobWorker workers[LS2D_JOB_MAX_THREADS];
+
+        SDL_mutex *lock; /**<Only used for sleeping and waking workers */
+        SDL_cond *cond;
+        atomic_uint queued;
+        atomic_bool stop;
+};
+
+/**
+ * Deque owned by the current thread
+ */
+static _Thread_local uint32_t job_thread = 0;
+
+static inline void ls2d_job_deque_lock(Ls2DJobDeque *deque)
+{
+        while (atomic_exchange_explicit(&deque->locked, true, memory_order_acquire)) {
+                /* spin */
+        }
+}
+
+static inline void ls2d_job_deque_unlock(Ls2DJobDeque *deque)
+{
+        atomic_store_explicit(&deque->locked, false, memory_order_release);
+}
+
+static bool ls2d_job_deque_push(Ls2DJobDeque *deque, const Ls2DJob *job)
+{
+        bool ret = false;
+
+        ls2d_job_deque_lock(deque);
+        if (deque->bottom - deque->top < LS2D_JOB_DEQUE_SIZE) {
+                deque->jobs[deque->bottom++ % LS2D_JOB_DEQUE_SIZE] = *job;
+                ret = true;
+        }
+        ls2d_job_deque_unlock(deque);
+        return ret;
+}
+
+static bool ls2d_job_deque_pop(Ls2DJobDeque *deque, Ls2DJob *job)
+{
+        bool ret = false;
+
+        ls2d_job_deque_lock(deque);
+        if (deque->bottom != deque->top) {
+                *job = deque->jobs[--deque->bottom % LS2D_JOB_DEQUE_SIZE];
+                ret = true;
+        }
+        ls2d_job_deque_unlock(deque);
+        return ret;
+}
+
+static bool ls2d_job_deque_steal(Ls2DJobDeque *deque, Ls2DJob *job)
+{
+        bool ret = false;
+
+        ls2d_job_deque_lock(deque);
+        if (deque->bottom != deque->top) {
+                *job = deque->jobs[deque->top++ % LS2D_JOB_DEQUE_SIZE];
+                ret = true;
+        }
+        ls2d_job_deque_unlock(deque);
+        return ret;
+}
+
+/**
+ * Run one job from our own deque, or failing that one stolen from another
+ */
+static bool ls2d_job_pool_run_one(Ls2DJobPool *self)
+{
+        Ls2DJob job;
+        uint32_t index = job_thread;
+        bool found = false;
+
+        if (atomic_load_explicit(&self->queued, memory_order_relaxed) == 0) {
+                return false;
+        }
+
+        found = ls2d_job_deque_pop(&self->deques[index], &job);
+        for (uint32_t i = 1; !found && i < self->n_threads; i++) {
+                found = ls2d_job_deque_steal(&self->deques[(index + i) % self->n_threads], &job);
+        }
+        if (!found) {
+                return false;
+        }
+
+        atomic_fetch_sub_explicit(&self->queued, 1, memory_order_relaxed);
+        job.func(job.userdata, job.begin, job.end);
+        atomic_fetch_sub_explicit(job.pending, 1, memory_order_release);
+        return true;
+}
+
+static int ls2d_job_pool_work(void *data)
+{
+        Ls2DJobWorker *worker = data;
+        Ls2DJobPool *self = worker->pool;
+
+        job_thread = worker->index;
+
+        for (;;) {
+                if (ls2d_job_pool_run_one(self)) {
+                        continue;
+                }
+
+                SDL_LockMutex(self->lock);
+                while (!atomic_load(&self->stop) && atomic_load(&self->queued) == 0) {
+                        SDL_CondWait(self->cond, self->lock);
+                }
+                SDL_UnlockMutex(self->lock);
+
+                if (atomic_load(&self->stop)) {
+                        break;
+                }
+        }
+
+        return 0;
+}
+
+Ls2DJobPool *ls2d_job_pool_new(uint32_t n_workers)
+{
+        Ls2DJobPool *self = NULL;
+
+        if (n_workers >= LS2D_JOB_MAX_THREADS) {
+                n_workers = LS2D_JOB_MAX_THREADS - 1;
+        }
+
+        self = calloc(1, sizeof(struct Ls2DJobPool));
+        if (ls_unlikely(!self)) {
+                return NULL;
+        }
+        self->n_threads = n_workers + 1;
+        self->deques = calloc(self->n_threads, sizeof(struct Ls2DJobDeque));
+        self->lock = SDL_CreateMutex();
+        self->cond = SDL_CreateCond();
+        if (ls_unlikely(!self->deques) || ls_unlikely(!self->lock) || ls_unlikely(!self->cond)) {
+                goto fail;
+        }
+
+        for (uint32_t i = 1; i < self->n_threads; i++) {
+                Ls2DJobWorker *worker = &self->workers[i];
+
+                worker->pool = self;
+                worker->index = i;
+                worker->thread = SDL_CreateThread(ls2d_job_pool_work, "ls2d-worker", worker);
+                if (!worker->thread) {
+                        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+                                     "Couldn't create worker thread: %s",
+                                     SDL_GetError());
+                        goto fail;
+                }
+        }
+
+        return self;
+
+fail:
+        ls2d_job_pool_free(self);
+        return NULL;
+}
+
+void ls2d_job_pool_free(Ls2DJobPool *self)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+
+        if (self->lock != NULL && self->cond != NULL) {
+                SDL_LockMutex(self->lock);
+                atomic_store(&self->stop, true);
+                SDL_CondBroadcast(self->cond);
+                SDL_UnlockMutex(self->lock);
+        }
+        for (uint32_t i = 1; i < self->n_threads; i++) {
+                if (self->workers[i].thread != NULL) {
+                        SDL_WaitThread(self->workers[i].thread, NULL);
+                }
+        }
+
+        if (self->cond != NULL) {
+                SDL_DestroyCond(self->cond);
+        }
+        if (self->lock != NULL) {
+                SDL_DestroyMutex(self->lock);
+        }
+        free(self->deques);
+        free(self);
+}
+
+uint32_t ls2d_job_pool_get_n_threads(Ls2DJobPool *self)
+{
+        if (ls_unlikely(!self)) {
+                return 1;
+        }
+        return self->n_threads;
+}
+
+/**
+ * Queue up [0, count) in ranges, spreading them over every deque so that
+ * workers can start without having to steal first.
+ */
+static void ls2d_job_pool_submit(Ls2DJobPool *self, uint32_t count, uint32_t grain,
+                                 ls2d_job_func func, void *userdata, atomic_uint *pending)
+{
+        uint32_t target = job_thread;
+
+        if (grain == 0) {
+                grain = count / (self->n_threads * LS2D_JOB_SPLIT);
+                if (grain == 0) {
+                        grain = 1;
+                }
+        }
+
+        for (uint32_t begin = 0; begin < count; begin += grain) {
+                Ls2DJob job = {
+                        .func = func,
+                        .userdata = userdata,
+                        .begin = begin,
+                        .end = count - begin > grain ? begin + grain : count,
+                        .pending = pending,
+                };
+
+                atomic_fetch_add_explicit(pending, 1, memory_order_relaxed);
+                atomic_fetch_add_explicit(&self->queued, 1, memory_order_relaxed);
+                if (!ls2d_job_deque_push(&self->deques[target], &job)) {
+                        /* Full, so do it ourselves */
+                        atomic_fetch_sub_explicit(&self->queued, 1, memory_order_relaxed);
+                        func(userdata, job.begin, job.end);
+                        atomic_fetch_sub_explicit(pending, 1, memory_order_relaxed);
+                }
+                target = (target + 1) % self->n_threads;
+        }
+}
+
+/**
+ * Wake the workers, then help out until everything counted in pending is done
+ */
+static void ls2d_job_pool_wait(Ls2DJobPool *self, atomic_uint *pending)
+{
+        SDL_LockMutex(self->lock);
+        SDL_CondBroadcast(self->cond);
+        SDL_UnlockMutex(self->lock);
+
+        while (atomic_load_explicit(pending, memory_order_acquire) > 0) {
+                ls2d_job_pool_run_one(self);
+        }
+}
+
+void ls2d_job_pool_parallel_for(Ls2DJobPool *self, uint32_t count, uint32_t grain,
+                                ls2d_job_func func, void *userdata)
+{
+        atomic_uint pending = 0;
+
+        if (ls_unlikely(!func) || count == 0) {
+                return;
+        }
+        if (!self || self->n_threads < 2) {
+                func(userdata, 0, count);
+                return;
+        }
+
+        ls2d_job_pool_submit(self, count, grain, func, userdata, &pending);
+        ls2d_job_pool_wait(self, &pending);
+}
+
+static inline bool ls2d_job_system_conflicts(const Ls2DJobSystem *a, const Ls2DJobSystem *b)
+{
+        return (a->writes & (b->reads | b->writes)) != 0 || (b->writes & a->reads) != 0;
+}
+
+void ls2d_job_pool_run_systems(Ls2DJobPool *self, const Ls2DJobSystem *systems,
+                               uint32_t n_systems)
+{
+        uint32_t start = 0;
+
+        if (ls_unlikely(!systems)) {
+                return;
+        }
+
+        while (start < n_systems) {
+                atomic_uint pending = 0;
+                uint32_t end = start + 1;
+
+                /* Grow the batch until the next system would conflict with it */
+                for (; end < n_systems; end++) {
+                        bool conflict = false;
+                        for (uint32_t i = start; i < end && !conflict; i++) {
+                                conflict = ls2d_job_system_conflicts(&systems[i], &systems[end]);
+                        }
+                        if (conflict) {
+                                break;
+                        }
+                }
+
+                for (uint32_t i = start; i < end; i++) {
+                        const Ls2DJobSystem *system = &systems[i];
+                        if (!self || self->n_threads < 2) {
+                                if (system->count > 0) {
+                                        system->func(system->userdata, 0, system->count);
+                                }
+                                continue;
+                        }
+                        ls2d_job_pool_submit(self,
+                                             system->count,
+                                             0,
+                                             system->func,
+                                             system->userdata,
+                                             &pending);
+                }
+                if (self && self->n_threads >= 2) {
+                        ls2d_job_pool_wait(self, &pending);
+                }
+
+                start = end;
+        }
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
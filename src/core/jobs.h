@@ -0,0 +1,95 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "ls2d.h"
+
+/**
+ * Ls2DJobPool runs work in parallel over a fixed set of worker threads.
+ * Each thread owns a deque of jobs and steals from the others once its
+ * own runs dry. The submitting thread joins in until its work is done,
+ * so every call below returns with all of its jobs complete.
+ */
+
+/**
+ * Process items [begin, end) of a parallel range
+ */
+typedef void (*ls2d_job_func)(void *userdata, uint32_t begin, uint32_t end);
+
+/**
+ * A parallel-for with declared component access. Systems which don't
+ * write anything the other reads or writes may run at the same time.
+ */
+struct Ls2DJobSystem {
+        uint32_t reads;  /**<LS2D_COMP_MASK bits of components read */
+        uint32_t writes; /**<LS2D_COMP_MASK bits of components written */
+        uint32_t count;  /**<Number of items to split into ranges */
+        ls2d_job_func func;
+        void *userdata;
+};
+
+/**
+ * Construct a new pool with n_workers threads in addition to the caller
+ */
+Ls2DJobPool *ls2d_job_pool_new(uint32_t n_workers);
+
+/**
+ * Stop the workers and free the pool
+ */
+void ls2d_job_pool_free(Ls2DJobPool *self);
+
+/**
+ * Return the number of threads taking part, including the caller
+ */
+uint32_t ls2d_job_pool_get_n_threads(Ls2DJobPool *self);
+
+/**
+ * Split [0, count) into ranges of at most grain items, or an automatic
+ * size when grain is 0, and run func over them in parallel. A NULL pool
+ * simply runs func over the whole range on the calling thread.
+ */
+void ls2d_job_pool_parallel_for(Ls2DJobPool *self, uint32_t count, uint32_t grain,
+                                ls2d_job_func func, void *userdata);
+
+/**
+ * Run the systems in order, except that consecutive systems without
+ * conflicting access are run concurrently.
+ */
+void ls2d_job_pool_run_systems(Ls2DJobPool *self, const Ls2DJobSystem *systems,
+                               uint32_t n_systems);
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -43,9 +43,18 @@ typedef struct Ls2DComponent Ls2DComponent;
 typedef struct Ls2DBasicEntity Ls2DBasicEntity;
 typedef struct Ls2DFrameInfo Ls2DFrameInfo;
 typedef struct Ls2DObject Ls2DObject;
+typedef struct Ls2DArena Ls2DArena;
+typedef struct Ls2DObjectStats Ls2DObjectStats;
 typedef struct Ls2DScene Ls2DScene;
+typedef struct Ls2DReplay Ls2DReplay;
+typedef struct Ls2DRenderQueue Ls2DRenderQueue;
+typedef struct Ls2DJobPool Ls2DJobPool;
+typedef struct Ls2DJobSystem Ls2DJobSystem;
+typedef struct Ls2DEngineStats Ls2DEngineStats;
+typedef struct Ls2DTimeStats Ls2DTimeStats;
 
 typedef uint16_t Ls2DTextureHandle;
+typedef uint32_t Ls2DEntityHandle;
 typedef struct Ls2DTextureCache Ls2DTextureCache;
 typedef struct Ls2DTextureNode Ls2DTextureNode;
 
@@ -55,11 +64,15 @@ typedef struct Ls2DAnimation Ls2DAnimation;
 typedef struct Ls2DTile Ls2DTile;
 typedef struct Ls2DTileMap Ls2DTileMap;
 typedef struct Ls2DImage Ls2DImage;
+typedef struct Ls2DWorld Ls2DWorld;
 
 #include "libls.h"
 #include "object.h"
+#include "object-stats.h"
+#include "profile.h"
 
 #include "animation.h"
+#include "arena.h"
 #include "camera.h"
 #include "component.h"
 #include "engine.h"
@@ -67,14 +80,19 @@ typedef struct Ls2DImage Ls2DImage;
 #include "frame.h"
 #include "game.h"
 #include "input-manager.h"
+#include "jobs.h"
+#include "render.h"
+#include "replay.h"
 #include "scene.h"
 #include "spritesheet.h"
+#include "stats.h"
 #include "texture-cache.h"
 #include "tilesheet.h"
 
 #include "entities/basic-entity.h"
 #include "entities/image.h"
 #include "entities/tilemap.h"
+#include "entities/world.h"
 
 /* Our components */
 enum Ls2DComponentID {
@@ -82,8 +100,17 @@ enum Ls2DComponentID {
         LS2D_COMP_ID_POSITION,
         LS2D_COMP_ID_SPRITE,
         LS2D_COMP_ID_ANIMATION,
+        LS2D_COMP_ID_TRANSFORM,
 };
 
+/**
+ * Component IDs below this have a bit in the entity signature and a direct
+ * slot on Ls2DBasicEntity. Higher IDs still work, but are found by a scan.
+ */
+#define LS2D_COMP_ID_SLOTS 32
+
+#define LS2D_COMP_MASK(id) (1u << (id))
+
 enum Ls2DTileOrientation {
         LS2D_TILE_ORIENTATION_NONE = 0,
         LS2D_TILE_ORIENTATION_ORTHOGONAL, /**<We actually only support orthogonal right now. */
@@ -93,6 +120,7 @@ enum Ls2DTileOrientation {
 #include "components/animation-component.h"
 #include "components/position.h"
 #include "components/sprite.h"
+#include "components/transform.h"
 
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
@@ -0,0 +1,180 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "ls2d.h"
+#include "object-stats-private.h"
+
+#ifdef LS2D_ENABLE_OBJECT_STATS
+
+/**
+ * Maximum number of distinct object types we'll track
+ */
+#define LS2D_OBJECT_STATS_TYPES 128
+
+typedef struct Ls2DObjectStatsEntry {
+        const Ls2DObjectTable *vtable;
+        size_t size; /**<Size of the first object created with this vtable */
+        atomic_uint_fast64_t live;
+        atomic_uint_fast64_t peak;
+        atomic_uint_fast64_t total;
+} Ls2DObjectStatsEntry;
+
+/**
+ * Entries are only ever appended, and published by bumping n_entries, so
+ * lookups don't need the lock. Registering a new type does.
+ */
+static Ls2DObjectStatsEntry entries[LS2D_OBJECT_STATS_TYPES];
+static atomic_uint n_entries;
+static atomic_bool locked;
+
+static Ls2DObjectStatsEntry *ls2d_object_stats_find(const Ls2DObjectTable *vtable,
+                                                    unsigned int n_entries_seen)
+{
+        for (unsigned int i = 0; i < n_entries_seen; i++) {
+                if (entries[i].vtable == vtable) {
+                        return &entries[i];
+                }
+        }
+        return NULL;
+}
+
+static Ls2DObjectStatsEntry *ls2d_object_stats_lookup(const Ls2DObjectTable *vtable, size_t size)
+{
+        Ls2DObjectStatsEntry *entry = NULL;
+        unsigned int n = atomic_load_explicit(&n_entries, memory_order_acquire);
+
+        entry = ls2d_object_stats_find(vtable, n);
+        if (ls_likely(entry != NULL)) {
+                return entry;
+        }
+
+        while (atomic_exchange_explicit(&locked, true, memory_order_acquire)) {
+                /* spin */
+        }
+
+        /* Someone may have beaten us to it */
+        n = atomic_load_explicit(&n_entries, memory_order_relaxed);
+        entry = ls2d_object_stats_find(vtable, n);
+        if (!entry && n < LS2D_OBJECT_STATS_TYPES) {
+                entry = &entries[n];
+                entry->vtable = vtable;
+                entry->size = size;
+                atomic_store_explicit(&n_entries, n + 1, memory_order_release);
+        }
+
+        atomic_store_explicit(&locked, false, memory_order_release);
+        return entry;
+}
+
+void ls2d_object_stats_created(const Ls2DObjectTable *vtable, size_t size)
+{
+        Ls2DObjectStatsEntry *entry = ls2d_object_stats_lookup(vtable, size);
+        uint_fast64_t live;
+        uint_fast64_t peak;
+
+        if (ls_unlikely(!entry)) {
+                return;
+        }
+
+        atomic_fetch_add_explicit(&entry->total, 1, memory_order_relaxed);
+        live = atomic_fetch_add_explicit(&entry->live, 1, memory_order_relaxed) + 1;
+        peak = atomic_load_explicit(&entry->peak, memory_order_relaxed);
+        while (live > peak && !atomic_compare_exchange_weak(&entry->peak, &peak, live)) {
+                /* retry with the updated peak */
+        }
+}
+
+void ls2d_object_stats_destroyed(const Ls2DObjectTable *vtable)
+{
+        Ls2DObjectStatsEntry *entry = ls2d_object_stats_lookup(vtable, 0);
+
+        if (ls_unlikely(!entry)) {
+                return;
+        }
+        atomic_fetch_sub_explicit(&entry->live, 1, memory_order_relaxed);
+}
+
+uint32_t ls2d_object_stats_get(Ls2DObjectStats *stats, uint32_t n_stats)
+{
+        const unsigned int n = atomic_load_explicit(&n_entries, memory_order_acquire);
+
+        for (uint32_t i = 0; i < n && i < n_stats; i++) {
+                Ls2DObjectStatsEntry *entry = &entries[i];
+
+                stats[i].obj_name = entry->vtable->obj_name;
+                stats[i].live = atomic_load(&entry->live);
+                stats[i].peak = atomic_load(&entry->peak);
+                stats[i].total = atomic_load(&entry->total);
+                stats[i].bytes = stats[i].live * entry->size;
+        }
+        return n;
+}
+
+void ls2d_object_stats_dump(FILE *file)
+{
+        Ls2DObjectStats stats[LS2D_OBJECT_STATS_TYPES];
+        uint32_t n = ls2d_object_stats_get(stats, LS2D_OBJECT_STATS_TYPES);
+
+        fprintf(file, "%-28s %8s %8s %10s %10s\n", "object", "live", "peak", "total", "bytes");
+        for (uint32_t i = 0; i < n; i++) {
+                fprintf(file,
+                        "%-28s %8lu %8lu %10lu %10lu\n",
+                        stats[i].obj_name,
+                        (unsigned long)stats[i].live,
+                        (unsigned long)stats[i].peak,
+                        (unsigned long)stats[i].total,
+                        (unsigned long)stats[i].bytes);
+        }
+}
+
+#else
+
+uint32_t ls2d_object_stats_get(__ls_unused__ Ls2DObjectStats *stats,
+                               __ls_unused__ uint32_t n_stats)
+{
+        return 0;
+}
+
+void ls2d_object_stats_dump(FILE *file)
+{
+        fprintf(file, "Built without object stats\n");
+}
+
+#endif
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
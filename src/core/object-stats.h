@@ -0,0 +1,63 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Live object counts per Ls2DObjectTable, only collected when built with
+ * the with-object-stats option.
+ */
+struct Ls2DObjectStats {
+        const char *obj_name;
+        uint64_t live;  /**<Objects currently alive */
+        uint64_t peak;  /**<Most objects alive at once */
+        uint64_t total; /**<Objects created so far */
+        uint64_t bytes; /**<Bytes held by live objects */
+};
+
+/**
+ * Copy out stats for up to n_stats object types, returning the number of
+ * types tracked. Returns 0 when object stats aren't built in.
+ */
+uint32_t ls2d_object_stats_get(Ls2DObjectStats *stats, uint32_t n_stats);
+
+/**
+ * Write a table of all tracked object types to file
+ */
+void ls2d_object_stats_dump(FILE *file);
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
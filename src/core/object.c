@@ -27,6 +27,24 @@
 #include <stdlib.h>
 
 #include "ls2d.h"
+#include "object-stats-private.h"
+#include "slab-private.h"
+
+/**
+ * Adjust the reference count, returning the previous value. Unshared
+ * objects skip the locked read-modify-write entirely.
+ */
+static inline int ls2d_object_ref_count_add(Ls2DObject *object, int delta)
+{
+        int ref_count;
+
+        if (object->shared) {
+                return atomic_fetch_add(&(object->ref_count), delta);
+        }
+        ref_count = atomic_load_explicit(&(object->ref_count), memory_order_relaxed);
+        atomic_store_explicit(&(object->ref_count), ref_count + delta, memory_order_relaxed);
+        return ref_count;
+}
 
 void *ls2d_object_ref(void *v)
 {
@@ -34,7 +52,7 @@ void *ls2d_object_ref(void *v)
         if (!v) {
                 return NULL;
         }
-        int ref_count = atomic_fetch_add(&(object->ref_count), 1);
+        int ref_count = ls2d_object_ref_count_add(object, 1);
         assert(ref_count >= 0);
         return v;
 }
@@ -45,30 +63,38 @@ void *ls2d_object_unref(void *v)
         if (!v) {
                 return NULL;
         }
-        int ref_count = atomic_fetch_sub(&(object->ref_count), 1);
+        int ref_count = ls2d_object_ref_count_add(object, -1);
         assert(ref_count > 0);
         if (ref_count == 1) {
-                printf("Killing object %s* %p\n", object->vtable->obj_name, (void *)object);
+                ls2d_object_stats_destroyed(object->vtable);
                 if (object->vtable->destroy) {
                         object->vtable->destroy(v);
-                } else {
-                        free(object);
                 }
+                ls2d_slab_free(object, object->size_class);
                 return NULL;
         }
         return v;
 }
 
+void ls2d_object_set_shared(void *v, bool shared)
+{
+        Ls2DObject *object = v;
+        if (ls_unlikely(!v)) {
+                return;
+        }
+        object->shared = shared;
+}
+
 void *ls2d_object_init(Ls2DObject *object, Ls2DObjectTable *vtable)
 {
         assert(object != NULL);
         assert(vtable != NULL);
         object->ref_count = ATOMIC_VAR_INIT(1);
         object->vtable = vtable;
+        object->shared = vtable->shared;
         if (ls_unlikely(!object->vtable->init)) {
                 return object;
         }
-        printf("Init object %s* %p\n", object->vtable->obj_name, (void *)object);
         /* TODO: Ensure init passes..? */
         object->vtable->init(object);
         return object;
@@ -76,15 +102,24 @@ void *ls2d_object_init(Ls2DObject *object, Ls2DObjectTable *vtable)
 
 Ls2DObject *ls2d_object_new(size_t size, Ls2DObjectTable *vtable)
 {
-        void *obj = NULL;
+        Ls2DObject *obj = NULL;
+        Ls2DArena *arena = ls2d_arena_get_current();
+        uint16_t size_class = LS2D_SLAB_HEAP;
 
         assert(size > sizeof(struct Ls2DObject));
-        obj = calloc(1, size);
+        if (arena != NULL) {
+                obj = ls2d_arena_alloc(arena, size);
+                size_class = LS2D_SLAB_ARENA;
+        } else {
+                obj = ls2d_slab_alloc(size, &size_class);
+        }
         if (!obj) {
                 fprintf(stderr, "Failed to allocate object %s\n", vtable->obj_name);
                 return NULL;
         }
-        return ls2d_object_init((Ls2DObject *)obj, vtable);
+        obj->size_class = size_class;
+        ls2d_object_stats_created(vtable, size);
+        return ls2d_object_init(obj, vtable);
 }
 
 /*
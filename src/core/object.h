@@ -24,6 +24,8 @@
 #pragma once
 
 #include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 /**
  * The init function for an object
@@ -42,6 +44,7 @@ typedef struct Ls2DObjectTable {
         ls2d_object_vfunc_init init;
         ls2d_object_vfunc_destroy destroy;
         const char *obj_name;
+        bool shared; /**<Objects of this type start out shared between threads */
 } Ls2DObjectTable;
 
 /**
@@ -49,6 +52,8 @@ typedef struct Ls2DObjectTable {
  */
 struct Ls2DObject {
         atomic_int ref_count;
+        uint16_t size_class; /**<Where ls2d_object_new got our memory from */
+        bool shared;         /**<Reference counting must be atomic */
         Ls2DObjectTable *vtable;
 };
 
@@ -61,6 +66,13 @@ void *ls2d_object_unref(void *v);
 
 void *ls2d_object_init(Ls2DObject *object, Ls2DObjectTable *vtable);
 
+/**
+ * Objects are owned by a single thread unless marked as shared, and only
+ * shared objects pay for atomic reference counting. Mark an object shared
+ * before a second thread may ref or unref it concurrently.
+ */
+void ls2d_object_set_shared(void *v, bool shared);
+
 Ls2DObject *ls2d_object_new(size_t size, Ls2DObjectTable *vtable);
 
 #define LS2D_NEW(x, y) (x *)ls2d_object_new(sizeof(x), &y)
@@ -0,0 +1,211 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#include <SDL.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ls2d.h"
+
+#ifdef LS2D_ENABLE_PROFILER
+
+/**
+ * Zones retained per thread before the oldest are overwritten
+ */
+#define LS2D_PROFILE_EVENTS 65536
+
+/**
+ * Maximum number of threads that may record zones
+ */
+#define LS2D_PROFILE_THREADS 16
+
+typedef struct Ls2DProfileEvent {
+        const char *name;
+        uint64_t start; /**<Performance counter at zone entry */
+        uint64_t end;   /**<Performance counter at zone exit */
+} Ls2DProfileEvent;
+
+/**
+ * Each ring only ever has a single writer, its owning thread, which
+ * publishes an event by advancing head. Rings live as long as the process.
+ */
+typedef struct Ls2DProfileRing {
+        Ls2DProfileEvent events[LS2D_PROFILE_EVENTS];
+        atomic_uint_fast64_t head;
+        SDL_threadID thread;
+} Ls2DProfileRing;
+
+static _Atomic(Ls2DProfileRing *) rings[LS2D_PROFILE_THREADS];
+static atomic_uint n_rings;
+static _Thread_local Ls2DProfileRing *thread_ring = NULL;
+static _Thread_local bool thread_disabled = false;
+
+static Ls2DProfileRing *ls2d_profile_get_ring(void)
+{
+        Ls2DProfileRing *ring = NULL;
+        unsigned int index;
+
+        if (ls_likely(thread_ring != NULL) || thread_disabled) {
+                return thread_ring;
+        }
+
+        index = atomic_fetch_add(&n_rings, 1);
+        if (ls_unlikely(index >= LS2D_PROFILE_THREADS)) {
+                SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Too many threads to profile");
+                thread_disabled = true;
+                return NULL;
+        }
+
+        ring = calloc(1, sizeof(struct Ls2DProfileRing));
+        if (ls_unlikely(!ring)) {
+                thread_disabled = true;
+                return NULL;
+        }
+        ring->thread = SDL_ThreadID();
+        atomic_store(&rings[index], ring);
+        thread_ring = ring;
+        return ring;
+}
+
+Ls2DProfileZone ls2d_profile_zone_begin(const char *name)
+{
+        return (Ls2DProfileZone){ .name = name, .start = SDL_GetPerformanceCounter() };
+}
+
+void ls2d_profile_zone_end(Ls2DProfileZone *zone)
+{
+        const uint64_t end = SDL_GetPerformanceCounter();
+        Ls2DProfileRing *ring = ls2d_profile_get_ring();
+        Ls2DProfileEvent *event = NULL;
+        uint64_t head;
+
+        if (ls_unlikely(!ring)) {
+                return;
+        }
+
+        head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        event = &ring->events[head % LS2D_PROFILE_EVENTS];
+        event->name = zone->name;
+        event->start = zone->start;
+        event->end = end;
+        atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+/**
+ * Return the index of the oldest event still retained in the ring
+ */
+static inline uint64_t ls2d_profile_ring_first(uint64_t head)
+{
+        return head > LS2D_PROFILE_EVENTS ? head - LS2D_PROFILE_EVENTS : 0;
+}
+
+bool ls2d_profile_write_trace(const char *filename)
+{
+        FILE *file = NULL;
+        uint64_t base = UINT64_MAX;
+        unsigned int count = atomic_load(&n_rings);
+        const char *separator = "";
+
+        if (count > LS2D_PROFILE_THREADS) {
+                count = LS2D_PROFILE_THREADS;
+        }
+
+        /* Timestamps are relative to the oldest retained zone */
+        for (unsigned int i = 0; i < count; i++) {
+                Ls2DProfileRing *ring = atomic_load(&rings[i]);
+                uint64_t head;
+
+                if (!ring) {
+                        continue;
+                }
+                head = atomic_load_explicit(&ring->head, memory_order_acquire);
+                for (uint64_t j = ls2d_profile_ring_first(head); j < head; j++) {
+                        const Ls2DProfileEvent *event = &ring->events[j % LS2D_PROFILE_EVENTS];
+                        if (event->start < base) {
+                                base = event->start;
+                        }
+                }
+        }
+
+        file = fopen(filename, "w");
+        if (!file) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't write trace %s", filename);
+                return false;
+        }
+
+        fprintf(file, "{\"traceEvents\":[\n");
+        for (unsigned int i = 0; i < count; i++) {
+                Ls2DProfileRing *ring = atomic_load(&rings[i]);
+                uint64_t head;
+
+                if (!ring) {
+                        continue;
+                }
+                head = atomic_load_explicit(&ring->head, memory_order_acquire);
+                for (uint64_t j = ls2d_profile_ring_first(head); j < head; j++) {
+                        const Ls2DProfileEvent *event = &ring->events[j % LS2D_PROFILE_EVENTS];
+                        const uint64_t start = ls2d_frame_info_counter_to_ns(event->start - base);
+                        const uint64_t duration =
+                            ls2d_frame_info_counter_to_ns(event->end - event->start);
+
+                        fprintf(file,
+                                "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,"
+                                "\"ts\":%.3f,\"dur\":%.3f}",
+                                separator,
+                                event->name,
+                                (unsigned long)ring->thread,
+                                (double)start / 1000.0,
+                                (double)duration / 1000.0);
+                        separator = ",\n";
+                }
+        }
+        fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+        return fclose(file) == 0;
+}
+
+#else
+
+bool ls2d_profile_write_trace(const char *filename)
+{
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+                     "Built without the profiler, not writing %s",
+                     filename);
+        return false;
+}
+
+#endif
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,90 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Scoped timing zones, only compiled in with the with-profiler build
+ * option. A zone opens where it is declared and closes when it leaves
+ * scope, so nested zones form the hierarchy:
+ *
+ *      LS2D_PROFILE_ZONE("load-level");
+ *
+ * Zone names are stored by pointer and must stay valid for the lifetime
+ * of the process, so use string literals or static tables.
+ */
+#ifdef LS2D_ENABLE_PROFILER
+
+typedef struct Ls2DProfileZone {
+        const char *name;
+        uint64_t start; /**<Performance counter at zone entry */
+} Ls2DProfileZone;
+
+Ls2DProfileZone ls2d_profile_zone_begin(const char *name);
+
+void ls2d_profile_zone_end(Ls2DProfileZone *zone);
+
+#define LS2D_PROFILE_PASTE(x, y) x##y
+#define LS2D_PROFILE_LOCAL(x, y) LS2D_PROFILE_PASTE(x, y)
+#define LS2D_PROFILE_ZONE(name)                                                                    \
+        __attribute__((cleanup(ls2d_profile_zone_end)))                                            \
+        Ls2DProfileZone LS2D_PROFILE_LOCAL(ls2d_zone_, __LINE__) = ls2d_profile_zone_begin(name)
+
+#else
+
+#define LS2D_PROFILE_ZONE(name) (void)0
+
+#endif
+
+/**
+ * Zone named after the enclosing function
+ */
+#define LS2D_PROFILE_FUNC() LS2D_PROFILE_ZONE(__func__)
+
+/**
+ * Zone named after the type of an Ls2DObject, i.e. "Ls2DTileMap"
+ */
+#define LS2D_PROFILE_OBJECT(obj) LS2D_PROFILE_ZONE(((Ls2DObject *)(obj))->vtable->obj_name)
+
+/**
+ * Write all retained zones from every thread as Chrome trace_event JSON,
+ * suitable for chrome://tracing or Perfetto. Call this once the engine
+ * has stopped running.
+ */
+bool ls2d_profile_write_trace(const char *filename);
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
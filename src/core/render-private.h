@@ -0,0 +1,99 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include "ls2d.h"
+
+/**
+ * Private API headers for the render queue implementation
+ */
+
+/**
+ * A single recorded ls2d_render_copy call
+ */
+typedef struct Ls2DRenderCommand {
+        Ls2DTextureNode *node;
+        SDL_Rect src;
+        SDL_Rect dst;
+        double angle;
+        SDL_RendererFlip flip;
+        SDL_Color color;
+        bool has_src;
+} Ls2DRenderCommand;
+
+/**
+ * Ls2DRenderQueue is a list of draw commands recorded for one frame. The
+ * storage is kept between frames so that steady-state recording doesn't
+ * allocate.
+ */
+struct Ls2DRenderQueue {
+        Ls2DRenderCommand *commands;
+        uint32_t len;
+        uint32_t size;
+
+        /* Geometry for one batch of quads, built while executing */
+        SDL_Vertex *vertices;
+        int *indices;
+        uint32_t n_quads; /**<Quads the vertex and index storage can hold */
+        bool no_geometry; /**<Renderer refused geometry, draw one by one */
+
+        uint64_t update; /**<Time (ns) spent in update producing this frame */
+        uint64_t draw;   /**<Time (ns) spent recording this frame */
+};
+
+/**
+ * Construct a new, empty render queue
+ */
+Ls2DRenderQueue *ls2d_render_queue_new(void);
+
+/**
+ * Free a render queue and its storage
+ */
+void ls2d_render_queue_free(Ls2DRenderQueue *self);
+
+/**
+ * Drop all recorded commands, retaining the storage
+ */
+void ls2d_render_queue_reset(Ls2DRenderQueue *self);
+
+/**
+ * Issue all recorded commands to the renderer, in order. Consecutive
+ * commands sharing a texture are drawn together as one batch of quads.
+ */
+void ls2d_render_queue_execute(Ls2DRenderQueue *self, SDL_Renderer *renderer);
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
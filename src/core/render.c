@@ -0,0 +1,378 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#include <SDL.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "ls2d.h"
+#include "render-private.h"
+
+#define LS2D_RENDER_QUEUE_SIZE 256
+
+/**
+ * Most quads drawn by one SDL_RenderGeometry call. Longer runs are split.
+ */
+#define LS2D_RENDER_BATCH_QUADS 4096
+
+static const SDL_Color ls2d_render_white = { 255, 255, 255, 255 };
+
+Ls2DRenderQueue *ls2d_render_queue_new()
+{
+        Ls2DRenderQueue *self = NULL;
+
+        self = calloc(1, sizeof(struct Ls2DRenderQueue));
+        if (ls_unlikely(!self)) {
+                return NULL;
+        }
+        self->commands = calloc(LS2D_RENDER_QUEUE_SIZE, sizeof(struct Ls2DRenderCommand));
+        if (ls_unlikely(!self->commands)) {
+                free(self);
+                return NULL;
+        }
+        self->size = LS2D_RENDER_QUEUE_SIZE;
+        return self;
+}
+
+void ls2d_render_queue_free(Ls2DRenderQueue *self)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        free(self->commands);
+        free(self->vertices);
+        free(self->indices);
+        free(self);
+}
+
+void ls2d_render_queue_reset(Ls2DRenderQueue *self)
+{
+        self->len = 0;
+        self->update = 0;
+        self->draw = 0;
+}
+
+static Ls2DRenderCommand *ls2d_render_queue_push(Ls2DRenderQueue *self)
+{
+        Ls2DRenderCommand *commands = NULL;
+        const size_t command_size = sizeof(struct Ls2DRenderCommand);
+
+        if (ls_unlikely(self->len >= self->size)) {
+                commands = realloc(self->commands, self->size * 2 * command_size);
+                if (ls_unlikely(!commands)) {
+                        return NULL;
+                }
+                self->commands = commands;
+                self->size *= 2;
+        }
+        return &self->commands[self->len++];
+}
+
+static inline bool ls2d_render_color_is_white(SDL_Color color)
+{
+        return color.r == 255 && color.g == 255 && color.b == 255 && color.a == 255;
+}
+
+/**
+ * The source rectangle within the texture, or NULL for all of it
+ */
+static inline const SDL_Rect *ls2d_render_command_src(Ls2DRenderCommand *command)
+{
+        if (command->has_src) {
+                return &command->src;
+        } else if (command->node->subregion) {
+                return &command->node->area;
+        }
+        return NULL;
+}
+
+static inline void ls2d_render_command_execute(Ls2DRenderCommand *command,
+                                               SDL_Renderer *renderer)
+{
+        SDL_Texture *texture = NULL;
+        bool tinted = !ls2d_render_color_is_white(command->color);
+        SDL_Color old = { 255, 255, 255, 255 };
+
+        texture = ls2d_texture_node_realize(command->node, renderer);
+        if (ls_unlikely(!texture)) {
+                return;
+        }
+
+        /* The texture is shared, so put back whatever mod it had */
+        if (tinted) {
+                SDL_GetTextureColorMod(texture, &old.r, &old.g, &old.b);
+                SDL_GetTextureAlphaMod(texture, &old.a);
+                SDL_SetTextureColorMod(texture,
+                                       command->color.r,
+                                       command->color.g,
+                                       command->color.b);
+                SDL_SetTextureAlphaMod(texture, command->color.a);
+        }
+        SDL_RenderCopyEx(renderer,
+                         texture,
+                         ls2d_render_command_src(command),
+                         &command->dst,
+                         command->angle,
+                         NULL,
+                         command->flip);
+        if (tinted) {
+                SDL_SetTextureColorMod(texture, old.r, old.g, old.b);
+                SDL_SetTextureAlphaMod(texture, old.a);
+        }
+}
+
+/**
+ * Make room for n_quads worth of vertices and indices. Indices only
+ * depend on the quad number, so they're filled in once here.
+ */
+static bool ls2d_render_queue_reserve_quads(Ls2DRenderQueue *self, uint32_t n_quads)
+{
+        SDL_Vertex *vertices = NULL;
+        int *indices = NULL;
+        uint32_t size = self->n_quads > 0 ? self->n_quads : 64;
+
+        if (ls_likely(n_quads <= self->n_quads)) {
+                return true;
+        }
+        while (size < n_quads) {
+                size *= 2;
+        }
+
+        vertices = realloc(self->vertices, size * 4 * sizeof(SDL_Vertex));
+        if (ls_unlikely(!vertices)) {
+                return false;
+        }
+        self->vertices = vertices;
+        indices = realloc(self->indices, size * 6 * sizeof(int));
+        if (ls_unlikely(!indices)) {
+                return false;
+        }
+        self->indices = indices;
+
+        for (uint32_t i = self->n_quads; i < size; i++) {
+                int base = (int)i * 4;
+                int *quad = &indices[i * 6];
+
+                quad[0] = base;
+                quad[1] = base + 1;
+                quad[2] = base + 2;
+                quad[3] = base + 2;
+                quad[4] = base + 3;
+                quad[5] = base;
+        }
+        self->n_quads = size;
+        return true;
+}
+
+/**
+ * Write the four corners of a command's quad, clockwise from top left,
+ * matching what SDL_RenderCopyEx would draw.
+ */
+static void ls2d_render_command_quad(Ls2DRenderCommand *command, SDL_Vertex *quad, float tex_w,
+                                     float tex_h)
+{
+        const SDL_Rect *src = ls2d_render_command_src(command);
+        const SDL_Rect *dst = &command->dst;
+        float u0 = 0.0f, v0 = 0.0f, u1 = 1.0f, v1 = 1.0f;
+        float half_w = (float)dst->w / 2.0f;
+        float half_h = (float)dst->h / 2.0f;
+        float center_x = (float)dst->x + half_w;
+        float center_y = (float)dst->y + half_h;
+        float corners[4][2] = {
+                { -half_w, -half_h },
+                { half_w, -half_h },
+                { half_w, half_h },
+                { -half_w, half_h },
+        };
+        float tmp;
+
+        if (src) {
+                u0 = (float)src->x / tex_w;
+                v0 = (float)src->y / tex_h;
+                u1 = (float)(src->x + src->w) / tex_w;
+                v1 = (float)(src->y + src->h) / tex_h;
+        }
+        if (command->flip & SDL_FLIP_HORIZONTAL) {
+                tmp = u0;
+                u0 = u1;
+                u1 = tmp;
+        }
+        if (command->flip & SDL_FLIP_VERTICAL) {
+                tmp = v0;
+                v0 = v1;
+                v1 = tmp;
+        }
+
+        /* Clockwise about the centre, as with SDL_RenderCopyEx */
+        if (command->angle != 0.0) {
+                double radians = command->angle * M_PI / 180.0;
+                float c = (float)cos(radians);
+                float s = (float)sin(radians);
+
+                for (int i = 0; i < 4; i++) {
+                        float x = corners[i][0];
+                        float y = corners[i][1];
+                        corners[i][0] = x * c - y * s;
+                        corners[i][1] = x * s + y * c;
+                }
+        }
+
+        for (int i = 0; i < 4; i++) {
+                quad[i].position.x = center_x + corners[i][0];
+                quad[i].position.y = center_y + corners[i][1];
+                quad[i].color = command->color;
+        }
+        quad[0].tex_coord = (SDL_FPoint){ u0, v0 };
+        quad[1].tex_coord = (SDL_FPoint){ u1, v0 };
+        quad[2].tex_coord = (SDL_FPoint){ u1, v1 };
+        quad[3].tex_coord = (SDL_FPoint){ u0, v1 };
+}
+
+/**
+ * Draw commands [begin, end), which all share texture, in one call
+ */
+static void ls2d_render_queue_flush(Ls2DRenderQueue *self, SDL_Renderer *renderer,
+                                    SDL_Texture *texture, uint32_t begin, uint32_t end)
+{
+        uint32_t n = end - begin;
+        int tex_w = 0, tex_h = 0;
+
+        if (n == 0) {
+                return;
+        }
+
+        /* A lone quad gains nothing from geometry */
+        if (n == 1 || self->no_geometry || !ls2d_render_queue_reserve_quads(self, n) ||
+            SDL_QueryTexture(texture, NULL, NULL, &tex_w, &tex_h) != 0) {
+                goto fallback;
+        }
+
+        for (uint32_t i = 0; i < n; i++) {
+                ls2d_render_command_quad(&self->commands[begin + i],
+                                         &self->vertices[i * 4],
+                                         (float)tex_w,
+                                         (float)tex_h);
+        }
+        if (ls_likely(SDL_RenderGeometry(renderer,
+                                         texture,
+                                         self->vertices,
+                                         (int)n * 4,
+                                         self->indices,
+                                         (int)n * 6) == 0)) {
+                return;
+        }
+
+        SDL_LogError(SDL_LOG_CATEGORY_RENDER,
+                     "Couldn't batch sprites, drawing individually: %s",
+                     SDL_GetError());
+        self->no_geometry = true;
+
+fallback:
+        for (uint32_t i = begin; i < end; i++) {
+                ls2d_render_command_execute(&self->commands[i], renderer);
+        }
+}
+
+void ls2d_render_queue_execute(Ls2DRenderQueue *self, SDL_Renderer *renderer)
+{
+        SDL_Texture *texture = NULL;
+        uint32_t begin = 0;
+
+        LS2D_PROFILE_FUNC();
+
+        /* Batch runs of the same texture, keeping draw order intact */
+        for (uint32_t i = 0; i < self->len; i++) {
+                SDL_Texture *next = ls2d_texture_node_realize(self->commands[i].node, renderer);
+
+                if (next == texture && i - begin < LS2D_RENDER_BATCH_QUADS) {
+                        continue;
+                }
+                ls2d_render_queue_flush(self, renderer, texture, begin, i);
+                texture = next;
+                begin = i;
+
+                /* Nothing to draw with, so skip it */
+                if (ls_unlikely(!texture)) {
+                        begin = i + 1;
+                }
+        }
+        ls2d_render_queue_flush(self, renderer, texture, begin, self->len);
+}
+
+void ls2d_render_copy(Ls2DFrameInfo *frame, const Ls2DTextureNode *node, const SDL_Rect *src,
+                      const SDL_Rect *dst, double angle, SDL_RendererFlip flip)
+{
+        ls2d_render_copy_color(frame, node, src, dst, angle, flip, ls2d_render_white);
+}
+
+void ls2d_render_copy_color(Ls2DFrameInfo *frame, const Ls2DTextureNode *node,
+                            const SDL_Rect *src, const SDL_Rect *dst, double angle,
+                            SDL_RendererFlip flip, SDL_Color color)
+{
+        Ls2DRenderCommand local = { 0 };
+        Ls2DRenderCommand *command = &local;
+
+        if (ls_unlikely(!node)) {
+                return;
+        }
+
+        /* Nothing decoded, nothing to draw */
+        if (ls_unlikely(!(node->parent ? node->parent : node)->loaded)) {
+                return;
+        }
+
+        /* Recording for the render thread? */
+        if (frame->queue != NULL) {
+                command = ls2d_render_queue_push(frame->queue);
+                if (ls_unlikely(!command)) {
+                        return;
+                }
+        }
+
+        command->node = (Ls2DTextureNode *)node;
+        command->dst = *dst;
+        command->angle = angle;
+        command->flip = flip;
+        command->color = color;
+        command->has_src = src != NULL;
+        if (src) {
+                command->src = *src;
+        }
+
+        if (frame->queue == NULL) {
+                ls2d_render_command_execute(command, frame->renderer);
+        }
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,60 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include "ls2d.h"
+
+/**
+ * Draw (part of) a texture node to the current target. All drawing from
+ * entities and components should go through this function: when the
+ * frame carries a render queue the draw is recorded for the render
+ * thread, otherwise it is issued immediately.
+ *
+ * If src is NULL, the node's own subregion (or the whole texture) is used.
+ */
+void ls2d_render_copy(Ls2DFrameInfo *frame, const Ls2DTextureNode *node, const SDL_Rect *src,
+                      const SDL_Rect *dst, double angle, SDL_RendererFlip flip);
+
+/**
+ * As ls2d_render_copy, modulating the texture by color. Colour is carried
+ * per draw, so tinted sprites still batch with untinted ones.
+ */
+void ls2d_render_copy_color(Ls2DFrameInfo *frame, const Ls2DTextureNode *node,
+                            const SDL_Rect *src, const SDL_Rect *dst, double angle,
+                            SDL_RendererFlip flip, SDL_Color color);
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
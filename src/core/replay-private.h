@@ -0,0 +1,87 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include "ls2d.h"
+
+/**
+ * Private API headers for the Ls2DReplay implementation
+ */
+
+/**
+ * A single recorded event, stamped with the frame time (ns) it was seen at
+ */
+typedef struct Ls2DReplayEvent {
+        uint64_t timestamp;
+        SDL_Event event;
+} Ls2DReplayEvent;
+
+/**
+ * Opaque Ls2DReplay implementation
+ */
+struct Ls2DReplay {
+        Ls2DObject object; /*< Parent */
+
+        LsArray *events;  /**<Array of Ls2DReplayEvent, ordered by timestamp */
+        LsArray *timings; /**<Array of Ls2DReplayTiming for the last run */
+        uint32_t cursor;  /**<Next event to be played back */
+};
+
+__attribute__((always_inline)) static inline Ls2DReplayEvent *ls2d_replay_get_event(
+    Ls2DReplay *self, uint32_t index)
+{
+        Ls2DReplayEvent *root = (Ls2DReplayEvent *)self->events->data;
+        return &(root[index]);
+}
+
+/**
+ * Rewind playback and clear any previous timings
+ */
+bool ls2d_replay_reset(Ls2DReplay *self);
+
+/**
+ * Return the next event due at or before timestamp, or NULL if there are
+ * none due yet.
+ */
+Ls2DReplayEvent *ls2d_replay_next_event(Ls2DReplay *self, uint64_t timestamp);
+
+/**
+ * Record the timings for a replayed frame
+ */
+bool ls2d_replay_push_timing(Ls2DReplay *self, uint64_t update, uint64_t draw);
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,286 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#include <SDL.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ls2d.h"
+#include "replay-private.h"
+
+#define LS2D_REPLAY_MAGIC "LS2DRPL1"
+
+static void ls2d_replay_init(Ls2DReplay *self);
+static void ls2d_replay_destroy(Ls2DReplay *self);
+
+/**
+ * We don't yet do anything fancy.
+ */
+Ls2DObjectTable replay_vtable = {
+        .init = (ls2d_object_vfunc_init)ls2d_replay_init,
+        .destroy = (ls2d_object_vfunc_destroy)ls2d_replay_destroy,
+        .obj_name = "Ls2DReplay",
+};
+
+Ls2DReplay *ls2d_replay_new()
+{
+        return LS2D_NEW(Ls2DReplay, replay_vtable);
+}
+
+static void ls2d_replay_init(Ls2DReplay *self)
+{
+        self->events = ls_array_new_size(sizeof(struct Ls2DReplayEvent), 64);
+        self->timings = ls_array_new_size(sizeof(struct Ls2DReplayTiming), 64);
+}
+
+Ls2DReplay *ls2d_replay_unref(Ls2DReplay *self)
+{
+        return ls2d_object_unref(self);
+}
+
+static void ls2d_replay_destroy(Ls2DReplay *self)
+{
+        if (ls_likely(self->events != NULL)) {
+                ls_array_free(self->events, NULL);
+        }
+        if (ls_likely(self->timings != NULL)) {
+                ls_array_free(self->timings, NULL);
+        }
+}
+
+/**
+ * Only input events are replayed. They're also plain data, whereas others
+ * (drop, user and syswm events) carry pointers that are meaningless once
+ * written to disk.
+ */
+static bool ls2d_replay_wants_event(const SDL_Event *event)
+{
+        switch (event->type) {
+        case SDL_QUIT:
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+        case SDL_TEXTINPUT:
+        case SDL_MOUSEMOTION:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        case SDL_MOUSEWHEEL:
+                return true;
+        default:
+                return false;
+        }
+}
+
+bool ls2d_replay_add_event(Ls2DReplay *self, uint64_t timestamp, SDL_Event *event)
+{
+        Ls2DReplayEvent *record = NULL;
+
+        if (ls_unlikely(!self) || ls_unlikely(!event)) {
+                return false;
+        }
+        if (!ls2d_replay_wants_event(event)) {
+                return true;
+        }
+        if (ls_unlikely(!ls_array_add(self->events, NULL))) {
+                return false;
+        }
+        record = ls2d_replay_get_event(self, self->events->len - 1);
+        record->timestamp = timestamp;
+        record->event = *event;
+        return true;
+}
+
+Ls2DReplay *ls2d_replay_new_from_file(const char *filename)
+{
+        Ls2DReplay *self = NULL;
+        FILE *file = NULL;
+        char magic[sizeof(LS2D_REPLAY_MAGIC) - 1] = { 0 };
+        uint32_t n_events = 0;
+        Ls2DReplayEvent record = { 0 };
+
+        file = fopen(filename, "rb");
+        if (!file) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't open replay %s", filename);
+                return NULL;
+        }
+
+        if (fread(magic, sizeof(magic), 1, file) != 1 ||
+            memcmp(magic, LS2D_REPLAY_MAGIC, sizeof(magic)) != 0) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Not a replay file: %s", filename);
+                goto fail;
+        }
+        if (fread(&n_events, sizeof(n_events), 1, file) != 1) {
+                goto fail;
+        }
+
+        self = ls2d_replay_new();
+        if (ls_unlikely(!self)) {
+                goto fail;
+        }
+
+        for (uint32_t i = 0; i < n_events; i++) {
+                if (fread(&record, sizeof(record), 1, file) != 1) {
+                        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+                                     "Truncated replay: %s",
+                                     filename);
+                        self = ls2d_replay_unref(self);
+                        goto fail;
+                }
+                if (!ls2d_replay_add_event(self, record.timestamp, &record.event)) {
+                        self = ls2d_replay_unref(self);
+                        goto fail;
+                }
+        }
+
+fail:
+        fclose(file);
+        return self;
+}
+
+bool ls2d_replay_save(Ls2DReplay *self, const char *filename)
+{
+        FILE *file = NULL;
+        uint32_t n_events = 0;
+        bool ret = false;
+
+        if (ls_unlikely(!self)) {
+                return false;
+        }
+
+        file = fopen(filename, "wb");
+        if (!file) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't write replay %s", filename);
+                return false;
+        }
+
+        n_events = self->events->len;
+        if (fwrite(LS2D_REPLAY_MAGIC, sizeof(LS2D_REPLAY_MAGIC) - 1, 1, file) != 1) {
+                goto end;
+        }
+        if (fwrite(&n_events, sizeof(n_events), 1, file) != 1) {
+                goto end;
+        }
+        if (n_events > 0 &&
+            fwrite(self->events->data, sizeof(Ls2DReplayEvent), n_events, file) != n_events) {
+                goto end;
+        }
+        ret = true;
+
+end:
+        if (fclose(file) != 0) {
+                ret = false;
+        }
+        return ret;
+}
+
+bool ls2d_replay_reset(Ls2DReplay *self)
+{
+        self->cursor = 0;
+        ls_array_free(self->timings, NULL);
+        self->timings = ls_array_new_size(sizeof(struct Ls2DReplayTiming), 64);
+        return self->timings != NULL;
+}
+
+Ls2DReplayEvent *ls2d_replay_next_event(Ls2DReplay *self, uint64_t timestamp)
+{
+        Ls2DReplayEvent *record = NULL;
+
+        if (self->cursor >= self->events->len) {
+                return NULL;
+        }
+        record = ls2d_replay_get_event(self, self->cursor);
+        if (record->timestamp > timestamp) {
+                return NULL;
+        }
+        self->cursor++;
+        return record;
+}
+
+bool ls2d_replay_push_timing(Ls2DReplay *self, uint64_t update, uint64_t draw)
+{
+        Ls2DReplayTiming *timing = NULL;
+
+        if (ls_unlikely(!ls_array_add(self->timings, NULL))) {
+                return false;
+        }
+        timing = &((Ls2DReplayTiming *)self->timings->data)[self->timings->len - 1];
+        timing->update = update;
+        timing->draw = draw;
+        return true;
+}
+
+uint32_t ls2d_replay_get_n_timings(Ls2DReplay *self)
+{
+        if (ls_unlikely(!self)) {
+                return 0;
+        }
+        return self->timings->len;
+}
+
+const Ls2DReplayTiming *ls2d_replay_get_timing(Ls2DReplay *self, uint32_t frame)
+{
+        if (ls_unlikely(!self) || ls_unlikely(frame >= self->timings->len)) {
+                return NULL;
+        }
+        return &((const Ls2DReplayTiming *)self->timings->data)[frame];
+}
+
+bool ls2d_replay_write_report(Ls2DReplay *self, const char *filename)
+{
+        FILE *file = NULL;
+
+        if (ls_unlikely(!self)) {
+                return false;
+        }
+
+        file = fopen(filename, "w");
+        if (!file) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't write report %s", filename);
+                return false;
+        }
+
+        fprintf(file, "frame,update_ns,draw_ns\n");
+        for (uint32_t i = 0; i < self->timings->len; i++) {
+                const Ls2DReplayTiming *timing = ls2d_replay_get_timing(self, i);
+                fprintf(file,
+                        "%u,%" PRIu64 ",%" PRIu64 "\n",
+                        i,
+                        timing->update,
+                        timing->draw);
+        }
+
+        return fclose(file) == 0;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,97 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include "ls2d.h"
+
+/**
+ * Timings (ns) for a single frame of a replay run
+ */
+typedef struct Ls2DReplayTiming {
+        uint64_t update; /**<Event dispatch and scene update */
+        uint64_t draw;   /**<Scene draw and present */
+} Ls2DReplayTiming;
+
+/**
+ * Construct a new, empty Ls2DReplay. Events may be added to it manually
+ * or by recording a live session with ls2d_engine_set_recorder.
+ */
+Ls2DReplay *ls2d_replay_new(void);
+
+/**
+ * Construct a new Ls2DReplay from a file previously written with
+ * ls2d_replay_save.
+ */
+Ls2DReplay *ls2d_replay_new_from_file(const char *filename);
+
+/**
+ * Unref a previously allocated Ls2DReplay
+ */
+Ls2DReplay *ls2d_replay_unref(Ls2DReplay *self);
+
+/**
+ * Append an event to the stream. The timestamp (ns) is relative to the
+ * first frame, and must not be earlier than the last added event. Only
+ * keyboard, mouse, text input and quit events are kept; anything else is
+ * silently skipped.
+ */
+bool ls2d_replay_add_event(Ls2DReplay *self, uint64_t timestamp, SDL_Event *event);
+
+/**
+ * Write the event stream to disk. The format is native-endian and only
+ * intended to be replayed on the same platform.
+ */
+bool ls2d_replay_save(Ls2DReplay *self, const char *filename);
+
+/**
+ * Return the number of frames timed by the last replay run
+ */
+uint32_t ls2d_replay_get_n_timings(Ls2DReplay *self);
+
+/**
+ * Return the timings for the given frame of the last replay run
+ */
+const Ls2DReplayTiming *ls2d_replay_get_timing(Ls2DReplay *self, uint32_t frame);
+
+/**
+ * Write the per-frame timings of the last replay run as CSV
+ */
+bool ls2d_replay_write_report(Ls2DReplay *self, const char *filename);
+
+DEF_AUTOFREE(Ls2DReplay, ls2d_replay_unref)
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,115 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#pragma once
+
+#include <SDL.h>
+
+#include "ls2d.h"
+
+/**
+ * Private API headers for the scene spatial index
+ */
+
+#define LS2D_SCENE_GRID_NO_CELL UINT32_MAX
+
+/**
+ * Entity slots whose position falls within one cell
+ */
+typedef struct Ls2DSceneCell {
+        uint32_t *slots;
+        uint32_t len;
+        uint32_t size;
+} Ls2DSceneCell;
+
+/**
+ * Where a slot lives in the grid, so it can be moved or removed directly
+ */
+typedef struct Ls2DSceneGridLocation {
+        uint32_t cell;
+        uint32_t pos;
+        int w; /**<Size of the box filed for the slot */
+        int h;
+} Ls2DSceneGridLocation;
+
+/**
+ * A loose uniform grid over the world. Each entity is filed under the cell
+ * holding its top-left corner, and the grid tracks the largest box filed
+ * so queries can look back far enough to catch any sprite hanging over
+ * from a neighbouring cell. Positions outside the bounds are
+ * clamped into the edge cells, and entities without a position share one
+ * extra cell that every query returns.
+ */
+typedef struct Ls2DSceneGrid {
+        SDL_Rect bounds;
+        int cell_size;
+        int cols;
+        int rows;
+        Ls2DSceneCell *cells; /**<cols * rows cells plus the unplaced cell */
+        Ls2DSceneGridLocation *locations; /**<Indexed by entity slot */
+        uint32_t n_locations;
+        int max_w; /**<Widest box in the grid */
+        int max_h; /**<Tallest box in the grid */
+        bool extent_dirty; /**<The largest box left, recompute at next query */
+} Ls2DSceneGrid;
+
+/**
+ * (Re)initialise the grid to cover bounds, dropping all entries
+ */
+bool ls2d_scene_grid_init(Ls2DSceneGrid *self, SDL_Rect bounds, int cell_size);
+
+/**
+ * Release all grid storage
+ */
+void ls2d_scene_grid_deinit(Ls2DSceneGrid *self);
+
+/**
+ * Insert the slot with the given bounding box, or into the unplaced cell
+ * when box is NULL. A slot already in the grid is moved.
+ */
+bool ls2d_scene_grid_insert(Ls2DSceneGrid *self, uint32_t slot, const SDL_Rect *box);
+
+/**
+ * Remove the slot from the grid, if present
+ */
+void ls2d_scene_grid_remove(Ls2DSceneGrid *self, uint32_t slot);
+
+/**
+ * Collect the slots of every box that may overlap view, plus all unplaced
+ * slots, into the growable *out buffer. Returns the count.
+ */
+uint32_t ls2d_scene_grid_query(Ls2DSceneGrid *self, const SDL_Rect *view, uint32_t **out,
+                               uint32_t *out_size);
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
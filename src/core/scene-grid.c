@@ -0,0 +1,300 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "scene-grid-private.h"
+
+static inline uint32_t ls2d_scene_grid_n_cells(Ls2DSceneGrid *self)
+{
+        return (uint32_t)(self->cols * self->rows);
+}
+
+static void ls2d_scene_grid_free_cells(Ls2DSceneGrid *self)
+{
+        if (!self->cells) {
+                return;
+        }
+        for (uint32_t i = 0; i <= ls2d_scene_grid_n_cells(self); i++) {
+                free(self->cells[i].slots);
+        }
+        free(self->cells);
+        self->cells = NULL;
+}
+
+bool ls2d_scene_grid_init(Ls2DSceneGrid *self, SDL_Rect bounds, int cell_size)
+{
+        ls2d_scene_grid_free_cells(self);
+
+        self->bounds = bounds;
+        self->cell_size = cell_size > 0 ? cell_size : 1;
+        self->cols = bounds.w > 0 ? (bounds.w + self->cell_size - 1) / self->cell_size : 1;
+        self->rows = bounds.h > 0 ? (bounds.h + self->cell_size - 1) / self->cell_size : 1;
+        self->max_w = 0;
+        self->max_h = 0;
+        self->extent_dirty = false;
+
+        self->cells = calloc(ls2d_scene_grid_n_cells(self) + 1, sizeof(struct Ls2DSceneCell));
+        if (ls_unlikely(!self->cells)) {
+                return false;
+        }
+        for (uint32_t i = 0; i < self->n_locations; i++) {
+                self->locations[i].cell = LS2D_SCENE_GRID_NO_CELL;
+        }
+        return true;
+}
+
+void ls2d_scene_grid_deinit(Ls2DSceneGrid *self)
+{
+        ls2d_scene_grid_free_cells(self);
+        free(self->locations);
+        self->locations = NULL;
+        self->n_locations = 0;
+}
+
+static inline int ls2d_scene_grid_clamp(int value, int max)
+{
+        if (value < 0) {
+                return 0;
+        }
+        return value >= max ? max - 1 : value;
+}
+
+static inline int ls2d_scene_grid_col(Ls2DSceneGrid *self, int x)
+{
+        int offset = x - self->bounds.x;
+        return ls2d_scene_grid_clamp(offset < 0 ? -1 : offset / self->cell_size, self->cols);
+}
+
+static inline int ls2d_scene_grid_row(Ls2DSceneGrid *self, int y)
+{
+        int offset = y - self->bounds.y;
+        return ls2d_scene_grid_clamp(offset < 0 ? -1 : offset / self->cell_size, self->rows);
+}
+
+/**
+ * Record the size of a slot's box, keeping the grid's largest extent
+ */
+static void ls2d_scene_grid_set_extent(Ls2DSceneGrid *self, uint32_t slot, const SDL_Rect *box)
+{
+        Ls2DSceneGridLocation *location = &self->locations[slot];
+        int w = box ? box->w : 0;
+        int h = box ? box->h : 0;
+
+        if ((w < location->w && location->w >= self->max_w) ||
+            (h < location->h && location->h >= self->max_h)) {
+                self->extent_dirty = true;
+        }
+        location->w = w;
+        location->h = h;
+        if (w > self->max_w) {
+                self->max_w = w;
+        }
+        if (h > self->max_h) {
+                self->max_h = h;
+        }
+}
+
+/**
+ * Find the largest extent again after the largest box left or shrank
+ */
+static void ls2d_scene_grid_update_extent(Ls2DSceneGrid *self)
+{
+        self->max_w = 0;
+        self->max_h = 0;
+        self->extent_dirty = false;
+        for (uint32_t i = 0; i < self->n_locations; i++) {
+                const Ls2DSceneGridLocation *location = &self->locations[i];
+
+                if (location->cell == LS2D_SCENE_GRID_NO_CELL) {
+                        continue;
+                }
+                if (location->w > self->max_w) {
+                        self->max_w = location->w;
+                }
+                if (location->h > self->max_h) {
+                        self->max_h = location->h;
+                }
+        }
+        self->extent_dirty = false;
+}
+
+void ls2d_scene_grid_remove(Ls2DSceneGrid *self, uint32_t slot)
+{
+        Ls2DSceneGridLocation *location = NULL;
+        Ls2DSceneCell *cell = NULL;
+        uint32_t moved;
+
+        if (slot >= self->n_locations || self->locations[slot].cell == LS2D_SCENE_GRID_NO_CELL) {
+                return;
+        }
+        location = &self->locations[slot];
+        cell = &self->cells[location->cell];
+
+        /* The largest box may be leaving, so work the extent out again */
+        if ((location->w > 0 && location->w >= self->max_w) ||
+            (location->h > 0 && location->h >= self->max_h)) {
+                self->extent_dirty = true;
+        }
+
+        /* Order within a cell doesn't matter, so swap the last one in */
+        moved = cell->slots[--cell->len];
+        cell->slots[location->pos] = moved;
+        self->locations[moved].pos = location->pos;
+        location->cell = LS2D_SCENE_GRID_NO_CELL;
+}
+
+bool ls2d_scene_grid_insert(Ls2DSceneGrid *self, uint32_t slot, const SDL_Rect *box)
+{
+        Ls2DSceneCell *cell = NULL;
+        uint32_t index;
+
+        if (ls_unlikely(!self->cells)) {
+                return false;
+        }
+
+        if (slot >= self->n_locations) {
+                uint32_t n = self->n_locations > 0 ? self->n_locations : 32;
+                Ls2DSceneGridLocation *locations = NULL;
+
+                while (n <= slot) {
+                        n *= 2;
+                }
+                locations = realloc(self->locations, n * sizeof(struct Ls2DSceneGridLocation));
+                if (ls_unlikely(!locations)) {
+                        return false;
+                }
+                for (uint32_t i = self->n_locations; i < n; i++) {
+                        locations[i].cell = LS2D_SCENE_GRID_NO_CELL;
+                }
+                self->locations = locations;
+                self->n_locations = n;
+        }
+
+        if (box) {
+                index = (uint32_t)(ls2d_scene_grid_row(self, box->y) * self->cols +
+                                   ls2d_scene_grid_col(self, box->x));
+        } else {
+                index = ls2d_scene_grid_n_cells(self);
+        }
+
+        /* Still in the same cell? Only the size can have changed */
+        if (self->locations[slot].cell == index) {
+                ls2d_scene_grid_set_extent(self, slot, box);
+                return true;
+        }
+        ls2d_scene_grid_remove(self, slot);
+
+        cell = &self->cells[index];
+        if (cell->len >= cell->size) {
+                uint32_t size = cell->size > 0 ? cell->size * 2 : 8;
+                uint32_t *slots = realloc(cell->slots, size * sizeof(uint32_t));
+                if (ls_unlikely(!slots)) {
+                        return false;
+                }
+                cell->slots = slots;
+                cell->size = size;
+        }
+        self->locations[slot].cell = index;
+        self->locations[slot].pos = cell->len;
+        self->locations[slot].w = 0;
+        self->locations[slot].h = 0;
+        cell->slots[cell->len++] = slot;
+        ls2d_scene_grid_set_extent(self, slot, box);
+        return true;
+}
+
+static bool ls2d_scene_grid_append(const Ls2DSceneCell *cell, uint32_t **out, uint32_t *out_size,
+                                   uint32_t *count)
+{
+        if (cell->len == 0) {
+                return true;
+        }
+        if (*count + cell->len > *out_size) {
+                uint32_t size = *out_size > 0 ? *out_size : 64;
+                uint32_t *grown = NULL;
+
+                while (size < *count + cell->len) {
+                        size *= 2;
+                }
+                grown = realloc(*out, size * sizeof(uint32_t));
+                if (ls_unlikely(!grown)) {
+                        return false;
+                }
+                *out = grown;
+                *out_size = size;
+        }
+        memcpy(*out + *count, cell->slots, cell->len * sizeof(uint32_t));
+        *count += cell->len;
+        return true;
+}
+
+uint32_t ls2d_scene_grid_query(Ls2DSceneGrid *self, const SDL_Rect *view, uint32_t **out,
+                               uint32_t *out_size)
+{
+        uint32_t count = 0;
+        int col0, col1, row0, row1;
+
+        if (ls_unlikely(!self->cells)) {
+                return 0;
+        }
+        if (self->extent_dirty) {
+                ls2d_scene_grid_update_extent(self);
+        }
+
+        /* Boxes are filed by top-left, so only look back for overhanging ones */
+        col0 = ls2d_scene_grid_col(self, view->x - self->max_w);
+        row0 = ls2d_scene_grid_row(self, view->y - self->max_h);
+        col1 = ls2d_scene_grid_col(self, view->x + view->w);
+        row1 = ls2d_scene_grid_row(self, view->y + view->h);
+
+        for (int row = row0; row <= row1; row++) {
+                for (int col = col0; col <= col1; col++) {
+                        if (!ls2d_scene_grid_append(&self->cells[row * self->cols + col],
+                                                    out,
+                                                    out_size,
+                                                    &count)) {
+                                return count;
+                        }
+                }
+        }
+        ls2d_scene_grid_append(&self->cells[ls2d_scene_grid_n_cells(self)],
+                               out,
+                               out_size,
+                               &count);
+        return count;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -24,14 +24,91 @@
 #define _GNU_SOURCE
 
 #include <SDL.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "ls2d.h"
+#include "scene-grid-private.h"
+
+#define LS2D_SCENE_INDEX_BITS 20
+#define LS2D_SCENE_INDEX_MASK ((1u << LS2D_SCENE_INDEX_BITS) - 1)
+#define LS2D_SCENE_GENERATION_MASK ((1u << (32 - LS2D_SCENE_INDEX_BITS)) - 1)
+#define LS2D_SCENE_NO_SLOT UINT32_MAX
+
+/**
+ * Updates between re-evaluating which activity tier entities are in, so
+ * entities change tier in batches rather than one by one.
+ */
+#define LS2D_SCENE_ACTIVITY_INTERVAL 8
+
+/**
+ * Default spatial index cell size, in world units
+ */
+#define LS2D_SCENE_CELL_SIZE 128
+
+/**
+ * Entities added between draws before the draw list is sorted from
+ * scratch, rather than each walking down from the end of the list.
+ */
+#define LS2D_SCENE_SORT_APPENDS 64
 
 static void ls2d_scene_init(Ls2DScene *self);
 static void ls2d_scene_destroy(Ls2DScene *self);
 
+/**
+ * Maps a handle to the entity's position in the entity list and the draw
+ * list. Unused slots are chained through next_free.
+ */
+typedef struct Ls2DSceneSlot {
+        uint32_t generation;
+        uint32_t index;
+        uint32_t rank; /**<Position in the draw list */
+        uint32_t next_free;
+        bool used;
+        atomic_bool moved; /**<Queued for re-indexing */
+        int layer;
+        uint64_t draw_key; /**<Packed (layer, z, y) */
+} Ls2DSceneSlot;
+
+typedef enum Ls2DSceneCommandType {
+        LS2D_SCENE_CMD_ADD_ENTITY = 0,
+        LS2D_SCENE_CMD_REMOVE_ENTITY,
+        LS2D_SCENE_CMD_ADD_COMPONENT,
+        LS2D_SCENE_CMD_REMOVE_COMPONENT,
+} Ls2DSceneCommandType;
+
+/**
+ * A structural change waiting for ls2d_scene_flush. References are held
+ * on any entity or component until it is applied.
+ */
+typedef struct Ls2DSceneCommand {
+        Ls2DSceneCommandType type;
+        Ls2DEntityHandle handle;
+        Ls2DEntity *entity;
+        Ls2DComponent *component;
+        int component_id;
+} Ls2DSceneCommand;
+
+/**
+ * How often an entity is updated, by distance from the camera view
+ */
+typedef enum Ls2DSceneTier {
+        LS2D_SCENE_TIER_ACTIVE = 0, /**<Every update, components batched */
+        LS2D_SCENE_TIER_REDUCED,    /**<Every reduced_interval updates */
+        LS2D_SCENE_TIER_DORMANT,    /**<Not updated at all */
+} Ls2DSceneTier;
+
+/**
+ * Per-entity bookkeeping, kept in the same order as the entity list
+ */
+typedef struct Ls2DSceneEntry {
+        uint32_t slot;
+        Ls2DSceneTier tier;
+        uint64_t skipped;     /**<Time missed while on the reduced tier (ns) */
+        uint64_t awake_until; /**<Held on the active tier until these ticks */
+} Ls2DSceneEntry;
+
 /**
  * Opaque Ls2DScene implementation
  */
@@ -40,9 +117,53 @@ struct Ls2DScene {
         const char *name;
 
         LsPtrArray *entities;        /**<Our list of entities to render. */
+        Ls2DSceneSlot *slots;        /**<Handle table for entities */
+        uint32_t n_slots;
+        uint32_t size;
+        uint32_t free_slot;
+        Ls2DSceneEntry *entries; /**<Bookkeeping for each entry in entities */
+        uint32_t entries_size;
+        uint32_t *order; /**<Slots sorted by draw key, ties in order added */
+        bool order_dirty;
+        uint32_t n_appended; /**<Added to the end of order since the last sort */
+        uint32_t n_detached; /**<Holes left by a flush, awaiting compaction */
+
+        /* Activity regions, disabled while active_margin is negative */
+        int active_margin;
+        int reduced_margin;
+        uint32_t reduced_interval;
+        uint64_t n_updates;
+        uint64_t ticks;
+        atomic_bool wake_pending;
+
+        /* Changes deferred to the next flush, reused every frame */
+        atomic_bool commands_locked;
+        Ls2DSceneCommand *commands;
+        uint32_t n_commands;
+        uint32_t commands_size;
         LsHashmap *cameras;          /**<Our set of cameras */
         Ls2DTextureCache *tex_cache; /**< Our private texture cache. */
         Ls2DCamera *active_camera;
+        Ls2DArena *arena; /**<Backs objects created between push_arena/pop_arena */
+
+        /* Components updated by their type's batch system, by component ID */
+        LsPtrArray *batches[LS2D_COMP_ID_SLOTS];
+
+        /* Every entity's transform, whatever its tier, kept breadth-first */
+        LsPtrArray *transforms;
+
+        /* Spatial index for culling, built against the active camera */
+        Ls2DSceneGrid grid;
+        bool grid_valid;
+        int cell_size;
+        uint32_t *visible; /**<Scratch space for draw queries */
+        uint32_t visible_size;
+        uint32_t *visible_sorted; /**<Radix sort scratch, same size as visible */
+        uint32_t sorted_size;
+        atomic_bool moved_locked;
+        uint32_t *moved; /**<Slots whose position changed since the last draw */
+        uint32_t n_moved;
+        uint32_t moved_size;
 };
 
 /**
@@ -59,9 +180,25 @@ Ls2DScene *ls2d_scene_new(void)
         return LS2D_NEW(Ls2DScene, scene_vtable);
 }
 
+Ls2DScene *ls2d_scene_new_with_arena(void)
+{
+        Ls2DScene *self = ls2d_scene_new();
+        if (ls_unlikely(!self)) {
+                return NULL;
+        }
+        self->arena = ls2d_arena_new();
+        if (ls_unlikely(!self->arena)) {
+                return ls2d_scene_unref(self);
+        }
+        return self;
+}
+
 static void ls2d_scene_init(Ls2DScene *self)
 {
         self->entities = ls_ptr_array_new();
+        self->free_slot = LS2D_SCENE_NO_SLOT;
+        self->active_margin = -1;
+        self->cell_size = LS2D_SCENE_CELL_SIZE;
         self->tex_cache = ls2d_texture_cache_new();
         self->cameras = ls_hashmap_new_full(ls_hashmap_string_hash,
                                             ls_hashmap_string_equal,
@@ -79,17 +216,86 @@ static inline void free_entity(void *v)
         (void)ls2d_entity_unref(v);
 }
 
+static void ls2d_scene_command_release(Ls2DSceneCommand *command)
+{
+        if (command->entity != NULL) {
+                ls2d_entity_unref(command->entity);
+        }
+        if (command->component != NULL) {
+                ls2d_component_unref(command->component);
+        }
+}
+
 static void ls2d_scene_destroy(Ls2DScene *self)
 {
+        /* Never flushed, so just drop the references */
+        for (uint32_t i = 0; i < self->n_commands; i++) {
+                ls2d_scene_command_release(&self->commands[i]);
+        }
+        free(self->commands);
+
+        /* Hand components back to their own update, they may outlive us */
+        for (int id = 0; id < LS2D_COMP_ID_SLOTS; id++) {
+                LsPtrArray *batch = self->batches[id];
+                if (!batch) {
+                        continue;
+                }
+                for (uint32_t i = 0; i < batch->len; i++) {
+                        ((Ls2DComponent *)batch->data[i])->batched = false;
+                }
+                ls_array_free(batch, NULL);
+        }
+        if (self->transforms != NULL) {
+                ls_array_free(self->transforms, NULL);
+        }
+
         if (ls_likely(self->entities != NULL)) {
+                for (uint32_t i = 0; i < self->entities->len; i++) {
+                        Ls2DEntity *entity = self->entities->data[i];
+                        if (entity->scene == self) {
+                                entity->scene = NULL;
+                        }
+                }
                 ls_array_free(self->entities, free_entity);
         }
+        ls2d_scene_grid_deinit(&self->grid);
+        free(self->visible);
+        free(self->visible_sorted);
+        free(self->moved);
+        free(self->slots);
+        free(self->entries);
+        free(self->order);
         if (ls_likely(self->tex_cache != NULL)) {
                 ls2d_texture_cache_unref(self->tex_cache);
         }
         if (ls_likely(self->cameras != NULL)) {
                 ls_hashmap_free(self->cameras);
         }
+
+        /* Everything allocated from the arena goes in one shot */
+        if (self->arena != NULL) {
+                ls2d_arena_free(self->arena);
+        }
+}
+
+void ls2d_scene_push_arena(Ls2DScene *self)
+{
+        if (ls_unlikely(!self) || ls_unlikely(!self->arena)) {
+                return;
+        }
+        ls2d_arena_push(self->arena);
+}
+
+void ls2d_scene_pop_arena(Ls2DScene *self)
+{
+        if (ls_unlikely(!self) || ls_unlikely(!self->arena)) {
+                return;
+        }
+        if (ls_unlikely(ls2d_arena_get_current() != self->arena)) {
+                SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Popping an arena the scene didn't push");
+                return;
+        }
+        ls2d_arena_pop();
 }
 
 const char *ls2d_scene_get_name(Ls2DScene *self)
@@ -108,44 +314,1044 @@ Ls2DTextureCache *ls2d_scene_get_texture_cache(Ls2DScene *self)
         return self->tex_cache;
 }
 
-static bool ls2d_scene_should_render(Ls2DScene *self, Ls2DEntity *entity)
+static inline uint16_t ls2d_scene_key_part(int value)
 {
-        if (ls_unlikely(!entity)) {
-                return false;
+        if (value < INT16_MIN) {
+                value = INT16_MIN;
+        } else if (value > INT16_MAX) {
+                value = INT16_MAX;
         }
-        if (ls_unlikely(!self->active_camera)) {
+        return (uint16_t)(value - INT16_MIN);
+}
+
+/**
+ * Pack the entity's layer, z and y into one key that sorts as unsigned.
+ * Entities without a position sort as if at z 0, y 0.
+ */
+static uint64_t ls2d_scene_draw_key(Ls2DSceneSlot *slot, Ls2DEntity *entity)
+{
+        Ls2DComponent *position = NULL;
+        SDL_Point pos = { 0 };
+        int z = 0;
+
+        position = ls2d_entity_get_component(entity, LS2D_COMP_ID_POSITION);
+        ls2d_position_component_get_xy((Ls2DPositionComponent *)position, &pos);
+        ls2d_position_component_get_z((Ls2DPositionComponent *)position, &z);
+
+        return (uint64_t)ls2d_scene_key_part(slot->layer) << 48 |
+               (uint64_t)ls2d_scene_key_part(z) << 32 | ((uint32_t)pos.y ^ 0x80000000u);
+}
+
+/**
+ * File the entity in the spatial index under its current position and
+ * sprite extents. If the sprite's size isn't known until its texture is
+ * decoded, it goes in the unplaced cell so it is always drawn, and false
+ * is returned so it can be filed properly once the texture is loaded.
+ */
+static bool ls2d_scene_index_entity(Ls2DScene *self, Ls2DEntity *entity, uint32_t slot)
+{
+        Ls2DComponent *position = NULL;
+        Ls2DComponent *sprite = NULL;
+        SDL_Point pos = { 0 };
+        SDL_Point size = { 0 };
+        SDL_Rect box = { 0 };
+        bool placed = false;
+        bool sized = true;
+
+        if (!self->grid_valid) {
                 return true;
         }
-        if (!ls2d_camera_entity_in_bounds(self->active_camera, entity)) {
-                return false;
+        position = ls2d_entity_get_component(entity, LS2D_COMP_ID_POSITION);
+        placed = ls2d_position_component_get_xy((Ls2DPositionComponent *)position, &pos);
+        if (placed) {
+                sprite = ls2d_entity_get_component(entity, LS2D_COMP_ID_SPRITE);
+                if (sprite) {
+                        sized = ls2d_sprite_component_get_size((Ls2DSpriteComponent *)sprite,
+                                                               self->tex_cache,
+                                                               &size);
+                }
+                box = (SDL_Rect){ pos.x, pos.y, size.x, size.y };
+        }
+        if (ls_unlikely(!ls2d_scene_grid_insert(&self->grid,
+                                                slot,
+                                                placed && sized ? &box : NULL))) {
+                /* Can't index it, so stop trusting the index */
+                self->grid_valid = false;
+                return true;
+        }
+        return !placed || sized;
+}
+
+/**
+ * Take over updating of any entity components that have a batch system.
+ * Components added to the entity later just use their own update.
+ */
+static void ls2d_scene_batch_entity(Ls2DScene *self, Ls2DEntity *entity)
+{
+        for (int id = 0; id < LS2D_COMP_ID_SLOTS; id++) {
+                Ls2DComponent *component = NULL;
+
+                if (!(entity->comp_mask & LS2D_COMP_MASK(id)) || !ls2d_component_get_system(id)) {
+                        continue;
+                }
+                component = ls2d_entity_get_component(entity, id);
+                if (!component || component->batched) {
+                        continue;
+                }
+                if (!self->batches[id]) {
+                        self->batches[id] = ls_ptr_array_new();
+                        if (ls_unlikely(!self->batches[id])) {
+                                continue;
+                        }
+                }
+                if (ls_likely(ls_array_add(self->batches[id], component))) {
+                        component->batched = true;
+                }
+        }
+}
+
+/**
+ * Include the entity's transform, if it has one, in propagation
+ */
+static void ls2d_scene_track_transform(Ls2DScene *self, Ls2DEntity *entity)
+{
+        Ls2DComponent *transform = NULL;
+
+        if (!(entity->comp_mask & LS2D_COMP_MASK(LS2D_COMP_ID_TRANSFORM))) {
+                return;
+        }
+        transform = ls2d_entity_get_component(entity, LS2D_COMP_ID_TRANSFORM);
+        if (!transform) {
+                return;
+        }
+        if (!self->transforms) {
+                self->transforms = ls_ptr_array_new();
+                if (ls_unlikely(!self->transforms)) {
+                        return;
+                }
+        }
+        ls_array_add(self->transforms, transform);
+}
+
+static void ls2d_scene_untrack_transform(Ls2DScene *self, Ls2DComponent *transform)
+{
+        LsPtrArray *transforms = self->transforms;
+
+        for (uint32_t i = 0; transform && transforms && i < transforms->len; i++) {
+                if (transforms->data[i] == transform) {
+                        /* Propagation puts things back in order */
+                        transforms->data[i] = transforms->data[--transforms->len];
+                        return;
+                }
+        }
+}
+
+/**
+ * Stop batching any components belonging to the entity
+ */
+static void ls2d_scene_unbatch_entity(Ls2DScene *self, Ls2DEntity *entity)
+{
+        for (int id = 0; id < LS2D_COMP_ID_SLOTS; id++) {
+                LsPtrArray *batch = self->batches[id];
+                if (!batch) {
+                        continue;
+                }
+                for (uint32_t i = 0; i < batch->len; i++) {
+                        Ls2DComponent *component = batch->data[i];
+                        if (component->parent_entity != entity) {
+                                continue;
+                        }
+                        component->batched = false;
+                        batch->data[i--] = batch->data[--batch->len];
+                }
+        }
+}
+
+static inline Ls2DEntityHandle ls2d_scene_make_handle(Ls2DScene *self, uint32_t slot)
+{
+        return (self->slots[slot].generation << LS2D_SCENE_INDEX_BITS) | slot;
+}
+
+static Ls2DSceneSlot *ls2d_scene_lookup(Ls2DScene *self, Ls2DEntityHandle handle)
+{
+        uint32_t slot = handle & LS2D_SCENE_INDEX_MASK;
+
+        if (ls_unlikely(!self) || slot >= self->n_slots) {
+                return NULL;
+        }
+        if (!self->slots[slot].used ||
+            self->slots[slot].generation != handle >> LS2D_SCENE_INDEX_BITS) {
+                return NULL;
+        }
+        return &self->slots[slot];
+}
+
+/**
+ * Grab an unused slot, growing the table if needed
+ */
+static uint32_t ls2d_scene_alloc_slot(Ls2DScene *self)
+{
+        uint32_t slot;
+
+        if (self->free_slot != LS2D_SCENE_NO_SLOT) {
+                slot = self->free_slot;
+                self->free_slot = self->slots[slot].next_free;
+                return slot;
+        }
+        if (ls_unlikely(self->n_slots > LS2D_SCENE_INDEX_MASK)) {
+                return LS2D_SCENE_NO_SLOT;
+        }
+        if (self->n_slots >= self->size) {
+                uint32_t size = self->size > 0 ? self->size * 2 : 32;
+                Ls2DSceneSlot *slots = realloc(self->slots, size * sizeof(struct Ls2DSceneSlot));
+                if (ls_unlikely(!slots)) {
+                        return LS2D_SCENE_NO_SLOT;
+                }
+                self->slots = slots;
+                self->size = size;
+        }
+        slot = self->n_slots++;
+        self->slots[slot] = (Ls2DSceneSlot){ .generation = 1 };
+        return slot;
+}
+
+static void ls2d_scene_free_slot(Ls2DScene *self, uint32_t slot)
+{
+        Ls2DSceneSlot *entry = &self->slots[slot];
+
+        /* Invalidate outstanding handles, never handing out generation 0 */
+        entry->used = false;
+        entry->generation = (entry->generation + 1) & LS2D_SCENE_GENERATION_MASK;
+        if (entry->generation == 0) {
+                entry->generation = 1;
+        }
+        entry->next_free = self->free_slot;
+        self->free_slot = slot;
+}
+
+/**
+ * Make room for n_entities more entities, so a batch of additions costs
+ * at most one reallocation of each table.
+ */
+static bool ls2d_scene_reserve(Ls2DScene *self, uint32_t n_entities)
+{
+        uint32_t need = self->entities->len + n_entities;
+
+        if (need > self->entries_size) {
+                uint32_t size = self->entries_size > 0 ? self->entries_size : 32;
+                Ls2DSceneEntry *entries = NULL;
+                uint32_t *order = NULL;
+
+                while (size < need) {
+                        size *= 2;
+                }
+                order = realloc(self->order, size * sizeof(uint32_t));
+                if (ls_unlikely(!order)) {
+                        return false;
+                }
+                self->order = order;
+                entries = realloc(self->entries, size * sizeof(struct Ls2DSceneEntry));
+                if (ls_unlikely(!entries)) {
+                        return false;
+                }
+                self->entries = entries;
+                self->entries_size = size;
+        }
+
+        /* Free slots only count once the table itself can't take them */
+        need = self->n_slots + n_entities;
+        if (need > self->size) {
+                uint32_t size = self->size > 0 ? self->size : 32;
+                Ls2DSceneSlot *slots = NULL;
+
+                while (size < need) {
+                        size *= 2;
+                }
+                slots = realloc(self->slots, size * sizeof(struct Ls2DSceneSlot));
+                if (ls_unlikely(!slots)) {
+                        return false;
+                }
+                self->slots = slots;
+                self->size = size;
         }
         return true;
 }
 
-void ls2d_scene_add_entity(Ls2DScene *self, Ls2DEntity *entity)
+Ls2DEntityHandle ls2d_scene_add_entity(Ls2DScene *self, Ls2DEntity *entity)
 {
+        uint32_t slot;
+
         if (ls_unlikely(!self) || ls_unlikely(!entity)) {
                 SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Ls2DScene not yet initialised");
-                return;
+                return LS2D_ENTITY_HANDLE_NONE;
+        }
+
+        if (ls_unlikely(!ls2d_scene_reserve(self, 1))) {
+                return LS2D_ENTITY_HANDLE_NONE;
+        }
+
+        slot = ls2d_scene_alloc_slot(self);
+        if (ls_unlikely(slot == LS2D_SCENE_NO_SLOT)) {
+                SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Ls2DScene entity limit reached");
+                return LS2D_ENTITY_HANDLE_NONE;
         }
 
         /* Insert entity into our list */
-        ls_array_add(self->entities, ls2d_object_ref(entity));
+        if (ls_unlikely(!ls_array_add(self->entities, ls2d_object_ref(entity)))) {
+                ls2d_entity_unref(entity);
+                ls2d_scene_free_slot(self, slot);
+                return LS2D_ENTITY_HANDLE_NONE;
+        }
+        self->slots[slot].used = true;
+        self->slots[slot].index = self->entities->len - 1;
+        self->slots[slot].layer = 0;
+        self->entries[self->entities->len - 1] = (Ls2DSceneEntry){ .slot = slot };
+        entity->handle = ls2d_scene_make_handle(self, slot);
+        entity->scene = self;
+        if (!ls2d_scene_index_entity(self, entity, slot)) {
+                ls2d_scene_entity_moved(self, entity->handle);
+        }
+
+        /* Goes last among equal keys, then finds its place at the next draw */
+        self->slots[slot].rank = self->entities->len - 1;
+        self->slots[slot].draw_key = ls2d_scene_draw_key(&self->slots[slot], entity);
+        self->order[self->entities->len - 1] = slot;
+        self->order_dirty = true;
+        self->n_appended++;
+
+        ls2d_scene_batch_entity(self, entity);
+        ls2d_scene_track_transform(self, entity);
+        return entity->handle;
+}
+
+Ls2DEntity *ls2d_scene_get_entity(Ls2DScene *self, Ls2DEntityHandle handle)
+{
+        Ls2DSceneSlot *slot = ls2d_scene_lookup(self, handle);
+
+        if (!slot) {
+                return NULL;
+        }
+        return self->entities->data[slot->index];
+}
+
+/**
+ * Drop the entity from the scene, leaving a hole in the entity and draw
+ * lists for ls2d_scene_compact to close.
+ */
+static void ls2d_scene_detach_entity(Ls2DScene *self, Ls2DSceneSlot *slot,
+                                     Ls2DEntityHandle handle)
+{
+        Ls2DEntity *entity = self->entities->data[slot->index];
+
+        ls2d_scene_unbatch_entity(self, entity);
+        ls2d_scene_untrack_transform(self,
+                                     ls2d_entity_get_component(entity, LS2D_COMP_ID_TRANSFORM));
+
+        self->entities->data[slot->index] = NULL;
+        self->order[slot->rank] = LS2D_SCENE_NO_SLOT;
+        self->n_detached++;
+
+        ls2d_scene_free_slot(self, handle & LS2D_SCENE_INDEX_MASK);
+        if (entity->handle == handle) {
+                entity->handle = LS2D_ENTITY_HANDLE_NONE;
+                entity->scene = NULL;
+        }
+        if (self->grid_valid) {
+                ls2d_scene_grid_remove(&self->grid, handle & LS2D_SCENE_INDEX_MASK);
+        }
+        ls2d_entity_unref(entity);
+}
+
+/**
+ * Close every hole left by detached entities in one pass. Survivors keep
+ * their relative order, so both update and draw order stay stable.
+ */
+static void ls2d_scene_compact(Ls2DScene *self)
+{
+        uint32_t len = 0;
+        uint32_t n_ordered = 0;
+
+        if (self->n_detached == 0) {
+                return;
+        }
+
+        for (uint32_t i = 0; i < self->entities->len; i++) {
+                if (!self->entities->data[i]) {
+                        continue;
+                }
+                self->entities->data[len] = self->entities->data[i];
+                self->entries[len] = self->entries[i];
+                self->slots[self->entries[len].slot].index = len;
+                len++;
+        }
+        for (uint32_t i = 0; i < self->entities->len; i++) {
+                if (self->order[i] == LS2D_SCENE_NO_SLOT) {
+                        continue;
+                }
+                self->order[n_ordered] = self->order[i];
+                self->slots[self->order[n_ordered]].rank = n_ordered;
+                n_ordered++;
+        }
+
+        self->entities->len = len;
+        self->n_detached = 0;
+}
+
+bool ls2d_scene_remove_entity(Ls2DScene *self, Ls2DEntityHandle handle)
+{
+        Ls2DSceneSlot *slot = ls2d_scene_lookup(self, handle);
+
+        if (!slot) {
+                return false;
+        }
+        ls2d_scene_detach_entity(self, slot, handle);
+        ls2d_scene_compact(self);
+        return true;
+}
+
+static inline void ls2d_scene_commands_lock(Ls2DScene *self)
+{
+        while (atomic_exchange_explicit(&self->commands_locked, true, memory_order_acquire)) {
+                /* spin */
+        }
+}
+
+static inline void ls2d_scene_commands_unlock(Ls2DScene *self)
+{
+        atomic_store_explicit(&self->commands_locked, false, memory_order_release);
+}
+
+static void ls2d_scene_queue(Ls2DScene *self, const Ls2DSceneCommand *command)
+{
+        bool queued = false;
+
+        ls2d_scene_commands_lock(self);
+        if (self->n_commands >= self->commands_size) {
+                uint32_t size = self->commands_size > 0 ? self->commands_size * 2 : 64;
+                Ls2DSceneCommand *commands =
+                    realloc(self->commands, size * sizeof(struct Ls2DSceneCommand));
+                if (ls_likely(commands != NULL)) {
+                        self->commands = commands;
+                        self->commands_size = size;
+                }
+        }
+        if (ls_likely(self->n_commands < self->commands_size)) {
+                self->commands[self->n_commands++] = *command;
+                queued = true;
+        }
+        ls2d_scene_commands_unlock(self);
+
+        if (ls_unlikely(!queued)) {
+                SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Ls2DScene dropped a queued change");
+                ls2d_scene_command_release((Ls2DSceneCommand *)command);
+        }
+}
+
+void ls2d_scene_queue_add_entity(Ls2DScene *self, Ls2DEntity *entity)
+{
+        if (ls_unlikely(!self) || ls_unlikely(!entity)) {
+                return;
+        }
+        ls2d_scene_queue(self,
+                         &(Ls2DSceneCommand){
+                             .type = LS2D_SCENE_CMD_ADD_ENTITY,
+                             .entity = ls2d_object_ref(entity),
+                         });
+}
+
+void ls2d_scene_queue_remove_entity(Ls2DScene *self, Ls2DEntityHandle handle)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        ls2d_scene_queue(self,
+                         &(Ls2DSceneCommand){
+                             .type = LS2D_SCENE_CMD_REMOVE_ENTITY,
+                             .handle = handle,
+                         });
+}
+
+void ls2d_scene_queue_add_component(Ls2DScene *self, Ls2DEntityHandle handle,
+                                    Ls2DComponent *component)
+{
+        if (ls_unlikely(!self) || ls_unlikely(!component)) {
+                return;
+        }
+        ls2d_scene_queue(self,
+                         &(Ls2DSceneCommand){
+                             .type = LS2D_SCENE_CMD_ADD_COMPONENT,
+                             .handle = handle,
+                             .component = ls2d_object_ref(component),
+                         });
+}
+
+void ls2d_scene_queue_remove_component(Ls2DScene *self, Ls2DEntityHandle handle,
+                                       int component_id)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        ls2d_scene_queue(self,
+                         &(Ls2DSceneCommand){
+                             .type = LS2D_SCENE_CMD_REMOVE_COMPONENT,
+                             .handle = handle,
+                             .component_id = component_id,
+                         });
+}
+
+/**
+ * Stop batching a single component
+ */
+static void ls2d_scene_unbatch_component(Ls2DScene *self, Ls2DComponent *component)
+{
+        LsPtrArray *batch = NULL;
+
+        if (!component->batched || component->comp_id < 0 ||
+            component->comp_id >= LS2D_COMP_ID_SLOTS) {
+                return;
+        }
+        batch = self->batches[component->comp_id];
+        for (uint32_t i = 0; batch && i < batch->len; i++) {
+                if (batch->data[i] == component) {
+                        batch->data[i] = batch->data[--batch->len];
+                        component->batched = false;
+                        return;
+                }
+        }
+}
+
+static void ls2d_scene_apply(Ls2DScene *self, Ls2DSceneCommand *command)
+{
+        Ls2DSceneSlot *slot = NULL;
+        Ls2DEntity *entity = NULL;
+        Ls2DComponent *component = NULL;
+
+        switch (command->type) {
+        case LS2D_SCENE_CMD_ADD_ENTITY:
+                ls2d_scene_add_entity(self, command->entity);
+                break;
+        case LS2D_SCENE_CMD_REMOVE_ENTITY:
+                /* Holes are closed once the whole flush is applied */
+                slot = ls2d_scene_lookup(self, command->handle);
+                if (slot) {
+                        ls2d_scene_detach_entity(self, slot, command->handle);
+                }
+                break;
+        case LS2D_SCENE_CMD_ADD_COMPONENT:
+                slot = ls2d_scene_lookup(self, command->handle);
+                if (!slot) {
+                        break;
+                }
+                entity = self->entities->data[slot->index];
+                ls2d_entity_add_component(entity, command->component);
+                /* Other tiers are batched when they come back to active */
+                if (self->entries[slot->index].tier == LS2D_SCENE_TIER_ACTIVE) {
+                        ls2d_scene_batch_entity(self, entity);
+                }
+                if (command->component->comp_id == LS2D_COMP_ID_TRANSFORM &&
+                    ls2d_entity_get_component(entity, LS2D_COMP_ID_TRANSFORM) ==
+                        command->component) {
+                        ls2d_scene_track_transform(self, entity);
+                }
+                ls2d_scene_entity_moved(self, command->handle);
+                break;
+        case LS2D_SCENE_CMD_REMOVE_COMPONENT:
+                entity = ls2d_scene_get_entity(self, command->handle);
+                component = ls2d_entity_get_component(entity, command->component_id);
+                if (!component) {
+                        break;
+                }
+                ls2d_scene_unbatch_component(self, component);
+                ls2d_entity_remove_component(entity, command->component_id);
+                if (command->component_id == LS2D_COMP_ID_TRANSFORM) {
+                        /* Another transform may have taken its place */
+                        ls2d_scene_untrack_transform(self, component);
+                        ls2d_scene_track_transform(self, entity);
+                }
+                ls2d_scene_entity_moved(self, command->handle);
+                break;
+        default:
+                break;
+        }
+}
+
+void ls2d_scene_flush(Ls2DScene *self)
+{
+        uint32_t n_added = 0;
+
+        if (ls_unlikely(!self) || self->n_commands == 0) {
+                return;
+        }
+
+        LS2D_PROFILE_FUNC();
+
+        /* Grow the tables once for everything being added */
+        for (uint32_t i = 0; i < self->n_commands; i++) {
+                if (self->commands[i].type == LS2D_SCENE_CMD_ADD_ENTITY) {
+                        n_added++;
+                }
+        }
+        ls2d_scene_reserve(self, n_added);
+
+        for (uint32_t i = 0; i < self->n_commands; i++) {
+                ls2d_scene_apply(self, &self->commands[i]);
+                ls2d_scene_command_release(&self->commands[i]);
+        }
+        self->n_commands = 0;
+        ls2d_scene_compact(self);
+}
+
+void ls2d_scene_foreach_entity(Ls2DScene *self, uint32_t signature, ls2d_scene_entity_func func,
+                               void *userdata)
+{
+        if (ls_unlikely(!self) || ls_unlikely(!func)) {
+                return;
+        }
+
+        for (uint32_t i = 0; i < self->entities->len; i++) {
+                Ls2DEntity *entity = self->entities->data[i];
+                if ((entity->comp_mask & signature) == signature) {
+                        func(entity, userdata);
+                }
+        }
+}
+
+void ls2d_scene_entity_moved(Ls2DScene *self, Ls2DEntityHandle handle)
+{
+        Ls2DSceneSlot *slot = ls2d_scene_lookup(self, handle);
+
+        if (!slot || atomic_exchange(&slot->moved, true)) {
+                return;
+        }
+
+        while (atomic_exchange_explicit(&self->moved_locked, true, memory_order_acquire)) {
+                /* spin */
+        }
+        if (self->n_moved >= self->moved_size) {
+                uint32_t size = self->moved_size > 0 ? self->moved_size * 2 : 64;
+                uint32_t *moved = realloc(self->moved, size * sizeof(uint32_t));
+                if (ls_likely(moved != NULL)) {
+                        self->moved = moved;
+                        self->moved_size = size;
+                }
+        }
+        if (ls_likely(self->n_moved < self->moved_size)) {
+                self->moved[self->n_moved++] = handle & LS2D_SCENE_INDEX_MASK;
+        } else {
+                /* Lost track of it, so rebuild from scratch next draw */
+                self->grid_valid = false;
+        }
+        atomic_store_explicit(&self->moved_locked, false, memory_order_release);
+}
+
+void ls2d_scene_set_cell_size(Ls2DScene *self, int cell_size)
+{
+        if (ls_unlikely(!self) || cell_size < 1) {
+                return;
+        }
+        self->cell_size = cell_size;
+        self->grid_valid = false;
+}
+
+void ls2d_scene_set_layer(Ls2DScene *self, Ls2DEntityHandle handle, int layer)
+{
+        Ls2DSceneSlot *slot = ls2d_scene_lookup(self, handle);
+
+        if (!slot || slot->layer == layer) {
+                return;
+        }
+        slot->layer = layer;
+        ls2d_scene_entity_moved(self, handle);
+}
+
+/**
+ * Rebuild the spatial index if the camera's world or the cell size changed
+ */
+static bool ls2d_scene_sync_grid(Ls2DScene *self)
+{
+        SDL_Rect bounds = { 0 };
+
+        if (!ls2d_camera_get_world_bounds(self->active_camera, &bounds)) {
+                return false;
+        }
+
+        if (self->grid_valid && (self->grid.cell_size != self->cell_size ||
+                                 memcmp(&bounds, &self->grid.bounds, sizeof(SDL_Rect)) != 0)) {
+                self->grid_valid = false;
+        }
+        if (self->grid_valid) {
+                return true;
+        }
+
+        if (!ls2d_scene_grid_init(&self->grid, bounds, self->cell_size)) {
+                return false;
+        }
+        self->grid_valid = true;
+        for (uint32_t i = 0; i < self->entities->len && self->grid_valid; i++) {
+                Ls2DEntity *entity = self->entities->data[i];
+                uint32_t slot = self->entries[i].slot;
+
+                if (!ls2d_scene_index_entity(self, entity, slot)) {
+                        ls2d_scene_entity_moved(self, ls2d_scene_make_handle(self, slot));
+                }
+        }
+        return self->grid_valid;
+}
+
+/**
+ * Pick up everything that moved since the last draw: new draw keys, and
+ * new cells in the spatial index.
+ */
+static void ls2d_scene_sync_moved(Ls2DScene *self)
+{
+        uint32_t n_pending = 0;
+
+        for (uint32_t i = 0; i < self->n_moved; i++) {
+                uint32_t index = self->moved[i];
+                Ls2DSceneSlot *slot = &self->slots[index];
+                Ls2DEntity *entity = NULL;
+                uint64_t key;
+
+                atomic_store(&slot->moved, false);
+                if (!slot->used) {
+                        continue;
+                }
+                entity = self->entities->data[slot->index];
+                key = ls2d_scene_draw_key(slot, entity);
+                if (key != slot->draw_key) {
+                        slot->draw_key = key;
+                        self->order_dirty = true;
+                }
+                if (!ls2d_scene_index_entity(self, entity, index)) {
+                        /* Texture not decoded yet, try again next draw */
+                        atomic_store(&slot->moved, true);
+                        self->moved[n_pending++] = index;
+                }
+        }
+        self->n_moved = n_pending;
+}
+
+typedef struct Ls2DSceneDrawItem {
+        uint64_t key;
+        uint32_t rank;
+        uint32_t slot;
+} Ls2DSceneDrawItem;
+
+static int ls2d_scene_compare_items(const void *a, const void *b)
+{
+        const Ls2DSceneDrawItem *x = a;
+        const Ls2DSceneDrawItem *y = b;
+
+        if (x->key != y->key) {
+                return x->key < y->key ? -1 : 1;
+        }
+        return (x->rank > y->rank) - (x->rank < y->rank);
+}
+
+/**
+ * Sort the whole draw list from scratch, keeping equal keys in their
+ * current order. Returns false if there was no memory to do so.
+ */
+static bool ls2d_scene_sort_draw_list_full(Ls2DScene *self)
+{
+        uint32_t n = self->entities->len;
+        Ls2DSceneDrawItem *items = malloc(n * sizeof(struct Ls2DSceneDrawItem));
+
+        if (ls_unlikely(!items)) {
+                return false;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+                items[i] = (Ls2DSceneDrawItem){
+                        .key = self->slots[self->order[i]].draw_key,
+                        .rank = i,
+                        .slot = self->order[i],
+                };
+        }
+        qsort(items, n, sizeof(struct Ls2DSceneDrawItem), ls2d_scene_compare_items);
+        for (uint32_t i = 0; i < n; i++) {
+                self->order[i] = items[i].slot;
+                self->slots[items[i].slot].rank = i;
+        }
+        free(items);
+        return true;
+}
+
+/**
+ * Re-sort the draw list. Only a handful of entities change key between
+ * frames, so insertion sort runs in close to linear time, and is stable
+ * so equal keys keep the order they were added in. A big batch of new
+ * entities gets a full sort instead.
+ */
+static void ls2d_scene_sort_draw_list(Ls2DScene *self)
+{
+        uint32_t *order = self->order;
+        uint32_t n_appended = self->n_appended;
+
+        if (!self->order_dirty) {
+                return;
+        }
+        self->order_dirty = false;
+        self->n_appended = 0;
+
+        if (n_appended > LS2D_SCENE_SORT_APPENDS && ls2d_scene_sort_draw_list_full(self)) {
+                return;
+        }
+        for (uint32_t i = 1; i < self->entities->len; i++) {
+                uint32_t slot = order[i];
+                uint64_t key = self->slots[slot].draw_key;
+                uint32_t j = i;
+
+                while (j > 0 && self->slots[order[j - 1]].draw_key > key) {
+                        order[j] = order[j - 1];
+                        self->slots[order[j]].rank = j;
+                        j--;
+                }
+                order[j] = slot;
+                self->slots[slot].rank = j;
+        }
+}
+
+/**
+ * LSD radix sort of unique draw list ranks, a byte at a time, skipping
+ * the bytes no rank below max uses. Leaves the result in values.
+ */
+static void ls2d_scene_sort_ranks(uint32_t *values, uint32_t *scratch, uint32_t n, uint32_t max)
+{
+        uint32_t *from = values;
+        uint32_t *to = scratch;
+
+        for (uint32_t shift = 0; shift < 32 && (max >> shift) != 0; shift += 8) {
+                uint32_t offsets[256] = { 0 };
+                uint32_t total = 0;
+                uint32_t *swap = NULL;
+
+                for (uint32_t i = 0; i < n; i++) {
+                        offsets[(from[i] >> shift) & 0xff]++;
+                }
+                for (uint32_t i = 0; i < 256; i++) {
+                        uint32_t count = offsets[i];
+                        offsets[i] = total;
+                        total += count;
+                }
+                for (uint32_t i = 0; i < n; i++) {
+                        to[offsets[(from[i] >> shift) & 0xff]++] = from[i];
+                }
+
+                swap = from;
+                from = to;
+                to = swap;
+        }
+
+        if (from != values) {
+                memcpy(values, from, n * sizeof(uint32_t));
+        }
 }
 
 void ls2d_scene_draw(Ls2DScene *self, Ls2DFrameInfo *frame)
 {
-        for (uint16_t i = 0; i < self->entities->len; i++) {
+        SDL_Rect view = { 0 };
+        uint32_t n_visible = 0;
+        bool culling = false;
+        uint32_t *sorted = NULL;
+
+        LS2D_PROFILE_FUNC();
+
+        /* Without a view there's nothing to cull against */
+        culling = self->active_camera != NULL &&
+                  ls2d_camera_get_view(self->active_camera, &view) && ls2d_scene_sync_grid(self);
+        ls2d_scene_sync_moved(self);
+        ls2d_scene_sort_draw_list(self);
+
+        if (!culling || !self->grid_valid) {
+                for (uint32_t i = 0; i < self->entities->len; i++) {
+                        Ls2DSceneSlot *slot = &self->slots[self->order[i]];
+                        ls2d_entity_draw(self->entities->data[slot->index], self->tex_cache, frame);
+                }
+                return;
+        }
+
+        n_visible = ls2d_scene_grid_query(&self->grid, &view, &self->visible, &self->visible_size);
+        if (n_visible == 0) {
+                return;
+        }
+
+        if (self->sorted_size < self->visible_size) {
+                sorted = realloc(self->visible_sorted, self->visible_size * sizeof(uint32_t));
+                if (ls_unlikely(!sorted)) {
+                        return;
+                }
+                self->visible_sorted = sorted;
+                self->sorted_size = self->visible_size;
+        }
+
+        /* Cells come back in spatial order, so restore draw order */
+        for (uint32_t i = 0; i < n_visible; i++) {
+                self->visible[i] = self->slots[self->visible[i]].rank;
+        }
+        ls2d_scene_sort_ranks(self->visible,
+                              self->visible_sorted,
+                              n_visible,
+                              self->entities->len - 1);
+
+        for (uint32_t i = 0; i < n_visible; i++) {
+                Ls2DSceneSlot *slot = &self->slots[self->order[self->visible[i]]];
+                ls2d_entity_draw(self->entities->data[slot->index], self->tex_cache, frame);
+        }
+}
+
+/**
+ * Shared by every job in one phase of ls2d_scene_update
+ */
+typedef struct Ls2DSceneJob {
+        Ls2DScene *scene;
+        Ls2DFrameInfo *frame;
+        LsPtrArray *batch;
+        ls2d_component_system_func system;
+} Ls2DSceneJob;
+
+void ls2d_scene_set_activity_regions(Ls2DScene *self, int active_margin, int reduced_margin,
+                                     uint32_t reduced_interval)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        self->active_margin = active_margin;
+        self->reduced_margin = reduced_margin > active_margin ? reduced_margin : active_margin;
+        self->reduced_interval = reduced_interval > 0 ? reduced_interval : 1;
+
+        /* Pick up the new regions straight away */
+        atomic_store(&self->wake_pending, true);
+}
+
+void ls2d_scene_wake_entity(Ls2DScene *self, Ls2DEntityHandle handle, uint64_t duration)
+{
+        Ls2DSceneSlot *slot = ls2d_scene_lookup(self, handle);
+
+        if (!slot) {
+                return;
+        }
+        self->entries[slot->index].awake_until = self->ticks + duration;
+        atomic_store(&self->wake_pending, true);
+}
+
+/**
+ * Distance from the camera view to the entity, in world units along the
+ * furthest axis. Entities without a position are treated as in view.
+ */
+static int ls2d_scene_view_distance(Ls2DEntity *entity, const SDL_Rect *view)
+{
+        Ls2DComponent *position = NULL;
+        SDL_Point pos = { 0 };
+        int dx = 0, dy = 0;
+
+        position = ls2d_entity_get_component(entity, LS2D_COMP_ID_POSITION);
+        if (!ls2d_position_component_get_xy((Ls2DPositionComponent *)position, &pos)) {
+                return 0;
+        }
+        if (pos.x < view->x) {
+                dx = view->x - pos.x;
+        } else if (pos.x > view->x + view->w) {
+                dx = pos.x - (view->x + view->w);
+        }
+        if (pos.y < view->y) {
+                dy = view->y - pos.y;
+        } else if (pos.y > view->y + view->h) {
+                dy = pos.y - (view->y + view->h);
+        }
+        return dx > dy ? dx : dy;
+}
+
+/**
+ * Sort entities into tiers around the camera. Only active entities keep
+ * their components batched; the rest update them through their entity
+ * at whatever rate their tier allows.
+ */
+static void ls2d_scene_update_activity(Ls2DScene *self)
+{
+        SDL_Rect view = { 0 };
+        bool enabled = self->active_margin >= 0 && self->active_camera != NULL &&
+                       ls2d_camera_get_view(self->active_camera, &view);
+
+        LS2D_PROFILE_FUNC();
+
+        for (uint32_t i = 0; i < self->entities->len; i++) {
                 Ls2DEntity *entity = self->entities->data[i];
-                if (!ls2d_scene_should_render(self, entity)) {
+                Ls2DSceneEntry *entry = &self->entries[i];
+                Ls2DSceneTier tier = LS2D_SCENE_TIER_ACTIVE;
+
+                if (enabled && entry->awake_until <= self->ticks) {
+                        int distance = ls2d_scene_view_distance(entity, &view);
+                        if (distance > self->reduced_margin) {
+                                tier = LS2D_SCENE_TIER_DORMANT;
+                        } else if (distance > self->active_margin) {
+                                tier = LS2D_SCENE_TIER_REDUCED;
+                        }
+                }
+                if (tier == entry->tier) {
                         continue;
                 }
-                ls2d_entity_draw(entity, self->tex_cache, frame);
+
+                if (tier == LS2D_SCENE_TIER_ACTIVE) {
+                        ls2d_scene_batch_entity(self, entity);
+                } else if (entry->tier == LS2D_SCENE_TIER_ACTIVE) {
+                        ls2d_scene_unbatch_entity(self, entity);
+                }
+                /* Dormant entities freeze rather than catch up on waking */
+                entry->skipped = 0;
+                entry->tier = tier;
         }
 }
 
+static void ls2d_scene_update_entities(void *userdata, uint32_t begin, uint32_t end)
+{
+        Ls2DSceneJob *job = userdata;
+        Ls2DScene *self = job->scene;
+
+        for (uint32_t i = begin; i < end; i++) {
+                Ls2DEntity *entity = self->entities->data[i];
+                Ls2DSceneEntry *entry = &self->entries[i];
+                Ls2DFrameInfo frame;
+
+                switch (entry->tier) {
+                case LS2D_SCENE_TIER_ACTIVE:
+                        ls2d_entity_update(entity, self->tex_cache, job->frame);
+                        break;
+                case LS2D_SCENE_TIER_REDUCED:
+                        /* Stagger by position so reduced updates spread across frames */
+                        if ((self->n_updates + i) % self->reduced_interval != 0) {
+                                entry->skipped += job->frame->tick_increment;
+                                break;
+                        }
+                        frame = *job->frame;
+                        frame.tick_increment += entry->skipped;
+                        entry->skipped = 0;
+                        ls2d_entity_update(entity, self->tex_cache, &frame);
+                        break;
+                default:
+                        break;
+                }
+        }
+}
+
+static void ls2d_scene_update_batch(void *userdata, uint32_t begin, uint32_t end)
+{
+        Ls2DSceneJob *job = userdata;
+
+        job->system((Ls2DComponent **)job->batch->data + begin,
+                    end - begin,
+                    job->scene->tex_cache,
+                    job->frame);
+}
+
 void ls2d_scene_update(Ls2DScene *self, Ls2DFrameInfo *frame)
 {
+        Ls2DSceneJob entities = { .scene = self, .frame = frame };
+        Ls2DSceneJob batches[LS2D_COMP_ID_SLOTS];
+        Ls2DJobSystem systems[LS2D_COMP_ID_SLOTS];
+        uint32_t n_systems = 0;
+
+        LS2D_PROFILE_FUNC();
+
         if (ls_likely(self->active_camera != NULL)) {
                 ls2d_camera_update(self->active_camera, frame);
                 frame->camera = self->active_camera;
@@ -153,10 +1359,50 @@ void ls2d_scene_update(Ls2DScene *self, Ls2DFrameInfo *frame)
                 frame->camera = NULL;
         }
 
-        for (uint16_t i = 0; i < self->entities->len; i++) {
-                Ls2DEntity *entity = self->entities->data[i];
-                ls2d_entity_update(entity, self->tex_cache, frame);
+        self->ticks = frame->ticks;
+        if (atomic_exchange(&self->wake_pending, false) ||
+            self->n_updates % LS2D_SCENE_ACTIVITY_INTERVAL == 0) {
+                ls2d_scene_update_activity(self);
+        }
+
+        /* Entities only touch their own state, so split them over the workers */
+        ls2d_job_pool_parallel_for(frame->jobs,
+                                   self->entities->len,
+                                   0,
+                                   ls2d_scene_update_entities,
+                                   &entities);
+
+        /* One system per component type rather than a call per component */
+        for (int id = 0; id < LS2D_COMP_ID_SLOTS; id++) {
+                LsPtrArray *batch = self->batches[id];
+                Ls2DJobSystem *system = &systems[n_systems];
+
+                if (!batch || batch->len == 0 || ls_unlikely(!ls2d_component_get_system(id))) {
+                        continue;
+                }
+                batches[n_systems] = (Ls2DSceneJob){
+                        .scene = self,
+                        .frame = frame,
+                        .batch = batch,
+                        .system = ls2d_component_get_system(id),
+                };
+                ls2d_component_get_system_access(id, &system->reads, &system->writes);
+                system->count = batch->len;
+                system->func = ls2d_scene_update_batch;
+                system->userdata = &batches[n_systems];
+                n_systems++;
         }
+        ls2d_job_pool_run_systems(frame->jobs, systems, n_systems);
+
+        /* Hierarchies cross entities, so this is one pass on this thread */
+        if (self->transforms != NULL) {
+                ls2d_transform_component_propagate((Ls2DComponent **)self->transforms->data,
+                                                   self->transforms->len);
+        }
+
+        /* Sync point: apply structural changes before anything is drawn */
+        ls2d_scene_flush(self);
+        self->n_updates++;
 }
 
 bool ls2d_scene_add_camera(Ls2DScene *self, const char *id, Ls2DCamera *camera)
@@ -33,6 +33,25 @@
  */
 Ls2DScene *ls2d_scene_new(void);
 
+/**
+ * Construct a scene with its own Ls2DArena. Objects created between
+ * ls2d_scene_push_arena and ls2d_scene_pop_arena are bump-allocated from
+ * it and released together when the scene is destroyed, so they must not
+ * be referenced beyond the life of the scene.
+ */
+Ls2DScene *ls2d_scene_new_with_arena(void);
+
+/**
+ * Allocate new objects on this thread from the scene arena, if it has one
+ */
+void ls2d_scene_push_arena(Ls2DScene *self);
+
+/**
+ * Stop allocating objects from the scene arena. This is refused unless
+ * the scene arena is the current one.
+ */
+void ls2d_scene_pop_arena(Ls2DScene *self);
+
 /**
  * Unref an allocated Scene. This will also deference any
  * attached resources.
@@ -47,9 +66,117 @@ void ls2d_scene_draw(Ls2DScene *self, Ls2DFrameInfo *frame);
 void ls2d_scene_update(Ls2DScene *self, Ls2DFrameInfo *frame);
 
 /**
- * Attach an entity to this scene.
+ * Entities within a scene are referred to by a 32-bit handle, packing a
+ * slot index with a generation. Once the entity is removed the slot's
+ * generation moves on, so stale handles resolve to NULL rather than to
+ * whichever entity reuses the slot.
+ */
+#define LS2D_ENTITY_HANDLE_NONE 0
+
+/**
+ * Attach an entity to this scene, returning its handle. Entities are
+ * updated in the order they were added, but drawn by layer, z and y (see
+ * ls2d_scene_set_layer), with insertion order only breaking ties.
+ */
+Ls2DEntityHandle ls2d_scene_add_entity(Ls2DScene *self, Ls2DEntity *entity);
+
+/**
+ * Resolve a handle to its entity, or NULL if the handle is stale. The
+ * scene retains ownership of the entity.
+ */
+Ls2DEntity *ls2d_scene_get_entity(Ls2DScene *self, Ls2DEntityHandle handle);
+
+/**
+ * Detach an entity from the scene, dropping the scene's reference
+ */
+bool ls2d_scene_remove_entity(Ls2DScene *self, Ls2DEntityHandle handle);
+
+/**
+ * Structural changes made while the scene is updating must be queued, and
+ * are applied together by ls2d_scene_flush once the update has finished.
+ * Queueing is safe from any entity update, including on worker threads.
+ * Queued entities and components are referenced by the queueing thread,
+ * so they must be owned by that thread, or marked with
+ * ls2d_object_set_shared before any other thread may touch them.
+ */
+
+/**
+ * Add the entity at the next flush. Its handle is available from
+ * ls2d_entity_get_handle after that.
+ */
+void ls2d_scene_queue_add_entity(Ls2DScene *self, Ls2DEntity *entity);
+
+/**
+ * Remove the entity at the next flush
+ */
+void ls2d_scene_queue_remove_entity(Ls2DScene *self, Ls2DEntityHandle handle);
+
+/**
+ * Add the component to the entity at the next flush
+ */
+void ls2d_scene_queue_add_component(Ls2DScene *self, Ls2DEntityHandle handle,
+                                    Ls2DComponent *component);
+
+/**
+ * Remove the entity's component with the given ID at the next flush
+ */
+void ls2d_scene_queue_remove_component(Ls2DScene *self, Ls2DEntityHandle handle,
+                                       int component_id);
+
+/**
+ * Apply all queued changes, in the order they were queued. This is done
+ * at the end of every ls2d_scene_update.
+ */
+void ls2d_scene_flush(Ls2DScene *self);
+
+/**
+ * Stop paying full update cost for entities far from the camera. Entities
+ * within active_margin of the camera view update every frame, those within
+ * reduced_margin every reduced_interval frames (seeing the time they
+ * missed), and anything further away goes dormant and isn't updated at
+ * all. Tiers are re-evaluated every few frames. Entities without a
+ * position are always active. A negative active_margin (the default)
+ * updates everything every frame.
+ */
+void ls2d_scene_set_activity_regions(Ls2DScene *self, int active_margin, int reduced_margin,
+                                     uint32_t reduced_interval);
+
+/**
+ * Keep an entity fully active for duration nanoseconds, wherever it is.
+ * Takes effect from the next update.
+ */
+void ls2d_scene_wake_entity(Ls2DScene *self, Ls2DEntityHandle handle, uint64_t duration);
+
+/**
+ * Drawing only visits entities near the camera view, found through a grid
+ * over the camera's world bounds. Position components report their moves
+ * automatically; call this if where or how deep an entity draws changes
+ * some other way. Safe from any entity update.
+ */
+void ls2d_scene_entity_moved(Ls2DScene *self, Ls2DEntityHandle handle);
+
+/**
+ * Entities draw sorted by layer, then position z, then position y, so
+ * sprites further down the screen overlap those behind them. Entities
+ * without a position sort as if at z 0, y 0, and ties draw in the order
+ * they were added. Layers default to 0.
+ */
+void ls2d_scene_set_layer(Ls2DScene *self, Ls2DEntityHandle handle, int layer);
+
+/**
+ * Set the size of the culling grid's cells in world units. Sprites of any
+ * size are culled against their full extents.
+ */
+void ls2d_scene_set_cell_size(Ls2DScene *self, int cell_size);
+
+typedef void (*ls2d_scene_entity_func)(Ls2DEntity *entity, void *userdata);
+
+/**
+ * Call func for every entity whose signature contains all of signature,
+ * built from LS2D_COMP_MASK bits.
  */
-void ls2d_scene_add_entity(Ls2DScene *self, Ls2DEntity *entity);
+void ls2d_scene_foreach_entity(Ls2DScene *self, uint32_t signature, ls2d_scene_entity_func func,
+                               void *userdata);
 
 bool ls2d_scene_add_camera(Ls2DScene *self, const char *id, Ls2DCamera *camera);
 
@@ -0,0 +1,69 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Size-class slab allocator backing ls2d_object_new. Blocks of the same
+ * class are carved from shared slabs and recycled through a free list,
+ * so short-lived objects of one type end up reusing the same memory.
+ */
+
+/**
+ * Size class for memory that didn't come from a slab and must be freed
+ * with free()
+ */
+#define LS2D_SLAB_HEAP 0
+
+/**
+ * Size class for memory owned by an Ls2DArena, which is never freed
+ * individually
+ */
+#define LS2D_SLAB_ARENA UINT16_MAX
+
+/**
+ * Allocate zeroed memory of at least size bytes. The size class is
+ * stored in size_class and must be handed back to ls2d_slab_free.
+ */
+void *ls2d_slab_alloc(size_t size, uint16_t *size_class);
+
+/**
+ * Return memory from ls2d_slab_alloc to its free list
+ */
+void ls2d_slab_free(void *ptr, uint16_t size_class);
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
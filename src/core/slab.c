@@ -0,0 +1,155 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libls.h"
+#include "slab-private.h"
+
+/**
+ * Bytes requested from the system each time a class runs dry
+ */
+#define LS2D_SLAB_SIZE (64 * 1024)
+
+/**
+ * Block sizes, kept to multiples of 16 so every block stays aligned
+ * for any object type. Larger objects go straight to the heap.
+ */
+static const size_t slab_sizes[] = { 32, 48, 64, 96, 128, 160, 192, 256, 384, 512, 768, 1024 };
+
+#define LS2D_SLAB_CLASSES (sizeof(slab_sizes) / sizeof(slab_sizes[0]))
+
+typedef struct Ls2DSlabBlock {
+        struct Ls2DSlabBlock *next;
+} Ls2DSlabBlock;
+
+/**
+ * Each class is guarded by a spinlock, as critical sections are only a
+ * couple of pointer swaps and objects can be created off the main thread.
+ */
+typedef struct Ls2DSlabClass {
+        atomic_bool locked;
+        Ls2DSlabBlock *free_list;
+} Ls2DSlabClass;
+
+static Ls2DSlabClass slab_classes[LS2D_SLAB_CLASSES];
+
+static inline void ls2d_slab_lock(Ls2DSlabClass *klass)
+{
+        while (atomic_exchange_explicit(&klass->locked, true, memory_order_acquire)) {
+                /* spin */
+        }
+}
+
+static inline void ls2d_slab_unlock(Ls2DSlabClass *klass)
+{
+        atomic_store_explicit(&klass->locked, false, memory_order_release);
+}
+
+/**
+ * Carve a fresh slab into blocks for the given class. Slabs are never
+ * returned to the system, they're recycled for the life of the process.
+ */
+static bool ls2d_slab_grow(Ls2DSlabClass *klass, size_t block_size)
+{
+        const size_t n_blocks = LS2D_SLAB_SIZE / block_size;
+        char *slab = malloc(LS2D_SLAB_SIZE);
+
+        if (ls_unlikely(!slab)) {
+                return false;
+        }
+
+        for (size_t i = 0; i < n_blocks; i++) {
+                Ls2DSlabBlock *block = (Ls2DSlabBlock *)(void *)(slab + i * block_size);
+                block->next = klass->free_list;
+                klass->free_list = block;
+        }
+        return true;
+}
+
+void *ls2d_slab_alloc(size_t size, uint16_t *size_class)
+{
+        Ls2DSlabClass *klass = NULL;
+        Ls2DSlabBlock *block = NULL;
+        uint16_t index;
+
+        for (index = 0; index < LS2D_SLAB_CLASSES; index++) {
+                if (size <= slab_sizes[index]) {
+                        break;
+                }
+        }
+        if (index == LS2D_SLAB_CLASSES) {
+                *size_class = LS2D_SLAB_HEAP;
+                return calloc(1, size);
+        }
+
+        klass = &slab_classes[index];
+        ls2d_slab_lock(klass);
+        if (!klass->free_list && !ls2d_slab_grow(klass, slab_sizes[index])) {
+                ls2d_slab_unlock(klass);
+                return NULL;
+        }
+        block = klass->free_list;
+        klass->free_list = block->next;
+        ls2d_slab_unlock(klass);
+
+        memset(block, 0, slab_sizes[index]);
+        *size_class = (uint16_t)(index + 1);
+        return block;
+}
+
+void ls2d_slab_free(void *ptr, uint16_t size_class)
+{
+        Ls2DSlabClass *klass = NULL;
+        Ls2DSlabBlock *block = ptr;
+
+        if (ls_unlikely(!ptr) || size_class == LS2D_SLAB_ARENA) {
+                return;
+        }
+        if (size_class == LS2D_SLAB_HEAP || ls_unlikely(size_class > LS2D_SLAB_CLASSES)) {
+                free(ptr);
+                return;
+        }
+
+        klass = &slab_classes[size_class - 1];
+        ls2d_slab_lock(klass);
+        block->next = klass->free_list;
+        klass->free_list = block;
+        ls2d_slab_unlock(klass);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
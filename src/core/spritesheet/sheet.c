@@ -68,7 +68,6 @@ Ls2DSpriteSheet *ls2d_sprite_sheet_unref(Ls2DSpriteSheet *self)
 static void ls2d_sprite_sheet_destroy(Ls2DSpriteSheet *self)
 {
         ls_hashmap_free(self->textures);
-        free(self);
 }
 
 Ls2DTextureHandle ls2d_sprite_sheet_lookup(Ls2DSpriteSheet *self, char *key)
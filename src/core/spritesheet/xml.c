@@ -43,6 +43,7 @@ bool ls2d_sprite_sheet_parse_xml(Ls2DSpriteSheet *self, const char *filename)
         bool ret = false;
         int r = 0;
         Ls2DSpriteSheetXML parser = { 0 };
+        LS2D_PROFILE_FUNC();
 
         fd = open(filename, O_RDONLY);
         if (fd < 0) {
@@ -0,0 +1,62 @@
+/*
+ * This file is part of lispysnake2d.
+ *
+ * Copyright (c) 2019 Lispy Snake, Ltd.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Summary of a series of timings, all given in nanoseconds.
+ */
+struct Ls2DTimeStats {
+        uint64_t min;
+        uint64_t avg;
+        uint64_t p99; /**<99th percentile */
+        uint64_t max;
+};
+
+/**
+ * Ls2DEngineStats is a snapshot of the recent frame timings within the
+ * engine, computed over the last LS2D_STATS_SAMPLES frames at most.
+ */
+struct Ls2DEngineStats {
+        uint64_t frames;      /**<Total frames recorded since start */
+        uint32_t samples;     /**<How many frames these stats cover */
+        double fps;           /**<Average frames per second over the samples */
+        Ls2DTimeStats frame;  /**<Full frame time, including any pacing delay */
+        Ls2DTimeStats update; /**<Time spent in scene updates */
+        Ls2DTimeStats draw;   /**<Time spent drawing and presenting */
+};
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
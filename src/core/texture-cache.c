@@ -33,8 +33,6 @@
 
 #define DEFAULT_CACHE_SIZE 2800
 
-DEF_AUTOFREE(SDL_Surface, SDL_FreeSurface)
-
 static void ls2d_texture_cache_init(Ls2DTextureCache *self);
 static void ls2d_texture_cache_destroy(Ls2DTextureCache *self);
 
@@ -44,7 +42,8 @@ static void ls2d_texture_cache_destroy(Ls2DTextureCache *self);
 struct Ls2DTextureCache {
         Ls2DObject object; /*< Parent */
 
-        LsArray *cache; /*< Cache of textures in an array */
+        LsPtrArray *cache; /*< Individually allocated nodes, so pointers stay valid */
+        uint32_t upload_cursor; /*< Nodes before this have no pending upload */
 };
 
 /**
@@ -63,7 +62,8 @@ Ls2DTextureCache *ls2d_texture_cache_new()
 
 static void ls2d_texture_cache_init(Ls2DTextureCache *self)
 {
-        self->cache = ls_array_new_size(sizeof(struct Ls2DTextureNode), DEFAULT_CACHE_SIZE);
+        self->cache = ls_ptr_array_new_size(DEFAULT_CACHE_SIZE);
+        self->upload_cursor = 0;
 }
 
 Ls2DTextureCache *ls2d_texture_cache_unref(Ls2DTextureCache *self)
@@ -71,11 +71,15 @@ Ls2DTextureCache *ls2d_texture_cache_unref(Ls2DTextureCache *self)
         return ls2d_object_unref(self);
 }
 
-static SDL_Texture *load_texture_internal(Ls2DTextureNode *node, Ls2DFrameInfo *frame)
+/**
+ * Decode the image into a surface. This doesn't touch the renderer, so it
+ * is safe to call away from the render thread.
+ */
+static SDL_Surface *decode_surface(Ls2DTextureNode *node)
 {
-        autofree(SDL_Surface) *img_surface = NULL;
-        autofree(SDL_Surface) *opt_surface = NULL;
-        SDL_Surface *win_surface = NULL;
+        SDL_Surface *img_surface = NULL;
+        SDL_Surface *opt_surface = NULL;
+        LS2D_PROFILE_FUNC();
 
         img_surface = IMG_Load(node->filename);
         if (!img_surface) {
@@ -83,38 +87,32 @@ static SDL_Texture *load_texture_internal(Ls2DTextureNode *node, Ls2DFrameInfo *
                 return NULL;
         }
 
-        /* If the window has no surface, we can't optimize it */
-        win_surface = SDL_GetWindowSurface(frame->window);
-        if (!win_surface) {
-                return SDL_CreateTextureFromSurface(frame->renderer, img_surface);
-        }
-
-        /* Try to optimize it */
+        /* Try to optimize it to match our render buffer */
         opt_surface = SDL_ConvertSurfaceFormat(img_surface, SDL_PIXELFORMAT_RGBA8888, 0);
         if (!opt_surface) {
                 fprintf(stderr,
                         "Failed to optimize surface %s: %s\n",
                         node->filename,
                         SDL_GetError());
-                return SDL_CreateTextureFromSurface(frame->renderer, img_surface);
+                return img_surface;
         }
-        return SDL_CreateTextureFromSurface(frame->renderer, opt_surface);
+        SDL_FreeSurface(img_surface);
+        return opt_surface;
 }
 
-static SDL_Texture *load_texture(Ls2DTextureNode *node, Ls2DFrameInfo *frame)
+/**
+ * Ensure the root node has its pixels decoded and its real width and
+ * height known.
+ */
+static void decode_node(Ls2DTextureNode *node)
 {
-        SDL_Texture *texture = NULL;
-
-        texture = load_texture_internal(node, frame);
-        if (ls_unlikely(!texture)) {
-                return NULL;
+        node->surface = decode_surface(node);
+        if (ls_unlikely(!node->surface)) {
+                return;
         }
-
-        /* Find out real width and height
-         * TODO: Don't bother for subregions.
-         */
-        SDL_QueryTexture(texture, NULL, NULL, &node->area.w, &node->area.h);
-        return texture;
+        node->area.w = node->surface->w;
+        node->area.h = node->surface->h;
+        node->loaded = true;
 }
 
 /**
@@ -129,6 +127,9 @@ static void clear_texture(Ls2DTextureNode *node)
         if (node->texture) {
                 SDL_DestroyTexture(node->texture);
         }
+        if (node->surface) {
+                SDL_FreeSurface(node->surface);
+        }
         if (node->filename) {
                 free(node->filename);
         }
@@ -137,8 +138,8 @@ static void clear_texture(Ls2DTextureNode *node)
 __attribute__((always_inline)) static inline Ls2DTextureNode *lookup_node(void *cache,
                                                                           Ls2DTextureHandle handle)
 {
-        Ls2DTextureNode *root = cache;
-        return &(root[handle]);
+        Ls2DTextureNode **nodes = cache;
+        return nodes[handle];
 }
 
 static void ls2d_texture_cache_destroy(Ls2DTextureCache *self)
@@ -146,7 +147,7 @@ static void ls2d_texture_cache_destroy(Ls2DTextureCache *self)
         for (uint16_t i = 0; i < self->cache->len; i++) {
                 clear_texture(lookup_node(self->cache->data, i));
         }
-        ls_array_free(self->cache, NULL);
+        ls_array_free(self->cache, free);
 }
 
 Ls2DTextureHandle ls2d_texture_cache_load_file(Ls2DTextureCache *self, const char *filename)
@@ -154,15 +155,20 @@ Ls2DTextureHandle ls2d_texture_cache_load_file(Ls2DTextureCache *self, const cha
         struct Ls2DTextureNode *node = NULL;
         uint32_t index = 0;
 
-        /* Preallocate cached texture */
-        ls_array_add(self->cache, NULL);
+        /* Nodes never move once allocated, so render queues may point at them */
+        node = calloc(1, sizeof(struct Ls2DTextureNode));
+        if (ls_unlikely(!node)) {
+                return 0;
+        }
+        ls_array_add(self->cache, node);
         index = (uint32_t)self->cache->len - 1;
-        node = lookup_node(self->cache->data, (Ls2DTextureHandle)index);
 
         /* Sort out the cache */
         node->filename = strdup(filename);
         node->subregion = false;
         node->texture = NULL;
+        node->surface = NULL;
+        node->loaded = false;
 
         return (Ls2DTextureHandle)index;
 }
@@ -177,37 +183,43 @@ Ls2DTextureHandle ls2d_texture_cache_subregion(Ls2DTextureCache *self, Ls2DTextu
         if (ls_unlikely(!self)) {
                 return 0;
         }
-        if (ls_unlikely(parent > self->cache->len)) {
+        if (ls_unlikely(parent >= self->cache->len)) {
                 return 0;
         }
 
         parent_node = lookup_node(self->cache->data, parent);
         assert(parent_node->subregion != true);
 
-        /* Preallocate cached texture */
-        ls_array_add(self->cache, NULL);
+        node = calloc(1, sizeof(struct Ls2DTextureNode));
+        if (ls_unlikely(!node)) {
+                return 0;
+        }
+        ls_array_add(self->cache, node);
         index = (uint32_t)self->cache->len - 1;
-        node = lookup_node(self->cache->data, (Ls2DTextureHandle)index);
 
         /* Sort out the cache */
         node->filename = NULL;
         node->subregion = true;
         node->area = subregion;
         node->texture = NULL;
+        node->surface = NULL;
+        node->loaded = false;
         node->parent = parent_node;
 
         return (Ls2DTextureHandle)index;
 }
 
-const Ls2DTextureNode *ls2d_texture_cache_lookup(Ls2DTextureCache *self, Ls2DFrameInfo *frame,
+const Ls2DTextureNode *ls2d_texture_cache_lookup(Ls2DTextureCache *self,
+                                                 __ls_unused__ Ls2DFrameInfo *frame,
                                                  Ls2DTextureHandle handle)
 {
         Ls2DTextureNode *node = NULL;
+        Ls2DTextureNode *root = NULL;
 
         if (ls_unlikely(!self)) {
                 return NULL;
         }
-        if (ls_unlikely(handle > self->cache->len)) {
+        if (ls_unlikely(handle >= self->cache->len)) {
                 return NULL;
         }
 
@@ -215,20 +227,104 @@ const Ls2DTextureNode *ls2d_texture_cache_lookup(Ls2DTextureCache *self, Ls2DFra
         if (ls_unlikely(!node)) {
                 return NULL;
         }
-        if (!node->texture) {
-                if (node->parent && !node->parent->texture) {
-                        node->parent->texture = load_texture(node->parent, frame);
-                        node->texture = node->parent->texture;
-                } else if (node->parent) {
-                        node->texture = node->parent->texture;
-                } else {
-                        node->texture = load_texture(node, frame);
-                }
+
+        /* Pixels are decoded here, but only uploaded when first drawn */
+        root = node->parent ? node->parent : node;
+        if (!root->loaded) {
+                decode_node(root);
         }
 
         return (const Ls2DTextureNode *)node;
 }
 
+const Ls2DTextureNode *ls2d_texture_cache_peek(Ls2DTextureCache *self, Ls2DTextureHandle handle)
+{
+        if (ls_unlikely(!self)) {
+                return NULL;
+        }
+        if (ls_unlikely(handle >= self->cache->len)) {
+                return NULL;
+        }
+        return (const Ls2DTextureNode *)lookup_node(self->cache->data, handle);
+}
+
+uint32_t ls2d_texture_cache_count_images(Ls2DTextureCache *self)
+{
+        uint32_t count = 0;
+
+        if (ls_unlikely(!self)) {
+                return 0;
+        }
+        for (uint32_t i = 0; i < self->cache->len; i++) {
+                if (!lookup_node(self->cache->data, (Ls2DTextureHandle)i)->subregion) {
+                        count++;
+                }
+        }
+        return count;
+}
+
+void ls2d_texture_cache_decode_all(Ls2DTextureCache *self, atomic_uint *progress)
+{
+        if (ls_unlikely(!self)) {
+                return;
+        }
+        for (uint32_t i = 0; i < self->cache->len; i++) {
+                Ls2DTextureNode *node = lookup_node(self->cache->data, (Ls2DTextureHandle)i);
+
+                if (node->subregion) {
+                        continue;
+                }
+                if (!node->loaded) {
+                        decode_node(node);
+                }
+                if (progress) {
+                        atomic_fetch_add(progress, 1);
+                }
+        }
+}
+
+uint32_t ls2d_texture_cache_upload(Ls2DTextureCache *self, SDL_Renderer *renderer, uint32_t max)
+{
+        uint32_t uploaded = 0;
+
+        if (ls_unlikely(!self)) {
+                return 0;
+        }
+        for (; self->upload_cursor < self->cache->len && uploaded < max; self->upload_cursor++) {
+                Ls2DTextureNode *node =
+                    lookup_node(self->cache->data, (Ls2DTextureHandle)self->upload_cursor);
+
+                if (node->subregion || !node->surface) {
+                        continue;
+                }
+                ls2d_texture_node_realize(node, renderer);
+                uploaded++;
+        }
+        return uploaded;
+}
+
+SDL_Texture *ls2d_texture_node_realize(Ls2DTextureNode *node, SDL_Renderer *renderer)
+{
+        Ls2DTextureNode *root = node->parent ? node->parent : node;
+
+        if (ls_unlikely(!root->texture) && root->surface) {
+                LS2D_PROFILE_FUNC();
+
+                root->texture = SDL_CreateTextureFromSurface(renderer, root->surface);
+                if (ls_unlikely(!root->texture)) {
+                        fprintf(stderr,
+                                "Failed to upload %s: %s\n",
+                                root->filename,
+                                SDL_GetError());
+                        return NULL;
+                }
+                SDL_FreeSurface(root->surface);
+                root->surface = NULL;
+        }
+        node->texture = root->texture;
+        return node->texture;
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
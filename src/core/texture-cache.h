@@ -26,11 +26,13 @@
 #include "ls2d.h"
 
 struct Ls2DTextureNode {
-        SDL_Texture *texture; /**< The real SDL_Texture */
+        SDL_Texture *texture; /**< The real SDL_Texture, once uploaded */
         SDL_Rect area;        /**< Displayable area for the texture. */
         char *filename;       /**<The filename we come from */
         bool subregion;       /**< Whether this node is a subregion. */
         struct Ls2DTextureNode *parent;
+        SDL_Surface *surface; /**< Decoded pixels awaiting upload */
+        bool loaded;          /**< Pixels have been decoded and area is valid */
 };
 
 /**
@@ -57,11 +59,45 @@ Ls2DTextureHandle ls2d_texture_cache_subregion(Ls2DTextureCache *self, Ls2DTextu
                                                SDL_Rect subregion);
 
 /**
- * Lookup a texture for rendering
+ * Lookup a texture for rendering. This will decode the image if needed,
+ * but the texture itself is only uploaded when it is first drawn, so the
+ * node should be passed to ls2d_render_copy rather than using its
+ * texture directly.
  */
 const Ls2DTextureNode *ls2d_texture_cache_lookup(Ls2DTextureCache *self, Ls2DFrameInfo *frame,
                                                  Ls2DTextureHandle handle);
 
+/**
+ * Look up a texture without decoding it. The area of an image node is
+ * only valid once the node (or for subregions, its parent) is loaded.
+ */
+const Ls2DTextureNode *ls2d_texture_cache_peek(Ls2DTextureCache *self, Ls2DTextureHandle handle);
+
+/**
+ * Return the number of images (nodes which aren't subregions) in the cache
+ */
+uint32_t ls2d_texture_cache_count_images(Ls2DTextureCache *self);
+
+/**
+ * Decode every image in the cache ahead of first use. This doesn't touch
+ * the renderer, so may run on a worker thread provided nothing else uses
+ * the cache meanwhile. If set, progress is bumped once per image.
+ */
+void ls2d_texture_cache_decode_all(Ls2DTextureCache *self, atomic_uint *progress);
+
+/**
+ * Upload up to max decoded images to the renderer, returning how many
+ * were uploaded. 0 means nothing is left pending. This must only be
+ * called from the thread owning the renderer.
+ */
+uint32_t ls2d_texture_cache_upload(Ls2DTextureCache *self, SDL_Renderer *renderer, uint32_t max);
+
+/**
+ * Return the SDL_Texture for a node, uploading decoded pixels first if
+ * required. This must only be called from the thread owning the renderer.
+ */
+SDL_Texture *ls2d_texture_node_realize(Ls2DTextureNode *node, SDL_Renderer *renderer);
+
 DEF_AUTOFREE(Ls2DTextureCache, ls2d_texture_cache_unref)
 
 /*
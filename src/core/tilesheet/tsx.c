@@ -47,6 +47,7 @@ bool ls2d_tile_sheet_parse_tsx(Ls2DTileSheet *self, const char *filename)
         bool ret = false;
         int r = 0;
         Ls2DTileSheetTSX parser = { 0 };
+        LS2D_PROFILE_FUNC();
 
         fd = open(filename, O_RDONLY);
         if (fd < 0) {
@@ -23,11 +23,23 @@
 
 #include <SDL.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "ls2d.h"
 
+/**
+ * Default length of a replay run, in frames
+ */
+#define DEMO_REPLAY_FRAMES 1000
+
+/**
+ * Default length of a headless run, which has no window to close
+ */
+#define DEMO_HEADLESS_FRAMES 1000
+
 typedef struct DemoGame {
         Ls2DGame parent;
+        const char *level; /**<TMX file to load, or NULL for the default */
         Ls2DScene *scene;
         Ls2DCamera *camera;
         Ls2DEntity *tilemap;
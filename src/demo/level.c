@@ -27,8 +27,14 @@ bool demo_game_load_tilemap(DemoGame *self)
 {
         Ls2DTextureCache *cache = ls2d_scene_get_texture_cache(self->scene);
         Ls2DTileSheet *tsx = NULL;
-        self->tilemap = ls2d_tilemap_new_from_tmx(cache, "data/level1.tmx");
-        ls2d_scene_add_entity(self->scene, self->tilemap);
+        const char *level = self->level ? self->level : "data/level1.tmx";
+        Ls2DEntityHandle handle;
+
+        self->tilemap = ls2d_tilemap_new_from_tmx(cache, level);
+        handle = ls2d_scene_add_entity(self->scene, self->tilemap);
+
+        /* Map sits underneath every sprite */
+        ls2d_scene_set_layer(self->scene, handle, -1);
 
         return true;
 }
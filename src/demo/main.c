@@ -80,13 +80,130 @@ void demo_game_destroy(Ls2DGame *game)
         fprintf(stderr, "Destroy end!\n");
 }
 
+static void demo_print_stats(Ls2DEngine *engine)
+{
+        Ls2DEngineStats stats = { 0 };
+
+        if (!ls2d_engine_get_stats(engine, &stats)) {
+                return;
+        }
+        fprintf(stderr,
+                "%lu frames, %.1f/fps\n"
+                "  frame  min %lu avg %lu p99 %lu max %lu ns\n"
+                "  update min %lu avg %lu p99 %lu max %lu ns\n"
+                "  draw   min %lu avg %lu p99 %lu max %lu ns\n",
+                (unsigned long)stats.frames,
+                stats.fps,
+                (unsigned long)stats.frame.min,
+                (unsigned long)stats.frame.avg,
+                (unsigned long)stats.frame.p99,
+                (unsigned long)stats.frame.max,
+                (unsigned long)stats.update.min,
+                (unsigned long)stats.update.avg,
+                (unsigned long)stats.update.p99,
+                (unsigned long)stats.update.max,
+                (unsigned long)stats.draw.min,
+                (unsigned long)stats.draw.avg,
+                (unsigned long)stats.draw.p99,
+                (unsigned long)stats.draw.max);
+}
+
 int main(int argc, char **argv)
 {
         autofree(Ls2DEngine) *engine = NULL;
+        autofree(Ls2DReplay) *replay = NULL;
         DemoGame game = { 0 };
+        bool headless = false;
+        bool threaded = false;
+        uint32_t budget = 0;
+        int jobs = 0;
+        uint32_t frames = 0;
+        const char *record_path = NULL;
+        const char *replay_path = NULL;
+        const char *report_path = NULL;
+        const char *trace_path = NULL;
+        int ret = EXIT_FAILURE;
+
         game.parent.funcs.init = demo_game_init;
         game.parent.funcs.destroy = demo_game_destroy;
 
-        engine = ls2d_engine_new(480, 270);
-        return ls2d_engine_run(engine, (Ls2DGame *)&game);
+        for (int i = 1; i < argc; i++) {
+                if (strcmp(argv[i], "--headless") == 0) {
+                        headless = true;
+                } else if (strcmp(argv[i], "--threaded") == 0) {
+                        threaded = true;
+                } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+                        jobs = atoi(argv[++i]);
+                } else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+                        budget = (uint32_t)strtoul(argv[++i], NULL, 10);
+                } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+                        frames = (uint32_t)strtoul(argv[++i], NULL, 10);
+                } else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) {
+                        game.level = argv[++i];
+                } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+                        record_path = argv[++i];
+                } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+                        replay_path = argv[++i];
+                } else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+                        report_path = argv[++i];
+                } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+                        trace_path = argv[++i];
+                } else {
+                        fprintf(stderr,
+                                "Usage: %s [--headless] [--threaded] [--jobs N] [--budget ms]\n"
+                                "       [--frames N] [--level file.tmx] [--record file]\n"
+                                "       [--replay file [--report file.csv]] [--trace file.json]\n",
+                                argv[0]);
+                        return EXIT_FAILURE;
+                }
+        }
+
+        engine = headless ? ls2d_engine_new_headless(480, 270) : ls2d_engine_new(480, 270);
+        if (!engine) {
+                return EXIT_FAILURE;
+        }
+        ls2d_engine_set_worker_threads(engine, jobs);
+
+        /* Replay a recorded session for a fixed number of frames */
+        if (replay_path) {
+                replay = ls2d_replay_new_from_file(replay_path);
+                if (!replay) {
+                        return EXIT_FAILURE;
+                }
+                ret = ls2d_engine_run_replay(engine,
+                                             (Ls2DGame *)&game,
+                                             replay,
+                                             frames > 0 ? frames : DEMO_REPLAY_FRAMES);
+                demo_print_stats(engine);
+                if (report_path && !ls2d_replay_write_report(replay, report_path)) {
+                        ret = EXIT_FAILURE;
+                }
+                if (trace_path && !ls2d_profile_write_trace(trace_path)) {
+                        ret = EXIT_FAILURE;
+                }
+                return ret;
+        }
+
+        if (record_path) {
+                replay = ls2d_replay_new();
+                ls2d_engine_set_recorder(engine, replay);
+        }
+        if (headless && frames == 0) {
+                frames = DEMO_HEADLESS_FRAMES;
+        }
+        ls2d_engine_set_frame_limit(engine, frames);
+        ls2d_engine_set_threaded(engine, threaded);
+        ls2d_engine_set_dynamic_resolution(engine, budget * LS2D_NS_PER_MS);
+
+        ret = ls2d_engine_run(engine, (Ls2DGame *)&game);
+        if (headless) {
+                demo_print_stats(engine);
+        }
+        if (record_path && !ls2d_replay_save(replay, record_path)) {
+                ret = EXIT_FAILURE;
+        }
+        if (trace_path && !ls2d_profile_write_trace(trace_path)) {
+                ret = EXIT_FAILURE;
+        }
+        return ret;
 }